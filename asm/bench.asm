@@ -0,0 +1,153 @@
+; Microbenchmark of add_long_long and sub_long_long. For every size from
+; bench_sizes each of them is run on operands of that size until it has
+; gone through BENCH_QWORDS qwords, and the time stamp counter ticks per
+; qword are printed. The counter runs at a constant rate, which need not be
+; the rate of the core clock.
+
+                section         .text
+
+                global          _start
+
+                extern          alloc
+                extern          free_heap
+                extern          add_long_long
+                extern          sub_long_long
+                extern          write_long
+                extern          write_char
+                extern          print_string
+                extern          exit
+
+BENCH_QWORDS:   equ             1 << 26
+
+_start:
+                xor             r12, r12
+.size:
+                mov             r13, [bench_sizes + 8 * r12]
+                test            r13, r13
+                jz              exit
+
+                mov             r8, add_long_long
+                mov             rsi, add_name
+                mov             rdx, add_name_size
+                call            measure
+                mov             r8, sub_long_long
+                mov             rsi, sub_name
+                mov             rdx, sub_name_size
+                call            measure
+
+                inc             r12
+                jmp             .size
+
+; runs a kernel BENCH_QWORDS / r13 times and prints its ticks per qword.
+; Operand #1 starts with all bits set and operand #2 with 1 in every qword
+; but the top one, so the minuend stays greater than the subtrahend
+;    r8 -- kernel
+;    rsi -- name of the kernel
+;    rdx -- length of the name
+;    r13 -- length of operands in qwords, a power of two up to BENCH_QWORDS
+measure:
+                call            print_string
+                mov             rax, r13
+                call            print_qword
+                mov             rsi, qwords_msg
+                mov             rdx, qwords_msg_size
+                call            print_string
+
+                call            free_heap
+                lea             rax, [8 * r13 + 8]
+                call            alloc
+                mov             r14, rax
+                mov             rdi, rax
+                mov             rcx, r13
+                mov             rax, -1
+                rep stosq
+                lea             rax, [8 * r13 + 8]
+                call            alloc
+                mov             r15, rax
+                mov             rdi, rax
+                mov             rcx, r13
+                mov             rax, 1
+                rep stosq
+                mov             qword [r15 + 8 * r13 - 8], 0
+
+                mov             rax, BENCH_QWORDS
+                xor             rdx, rdx
+                div             r13
+                mov             rbx, rax
+
+                rdtsc
+                shl             rdx, 32
+                or              rax, rdx
+                mov             rbp, rax
+.loop:
+                mov             rdi, r14
+                mov             rcx, r13
+                mov             rsi, r15
+                mov             rdx, r13
+                call            r8
+                dec             rbx
+                jnz             .loop
+                rdtsc
+                shl             rdx, 32
+                or              rax, rdx
+                sub             rax, rbp
+
+; hundredths of a tick per qword
+                mov             rcx, 100
+                mul             rcx
+                mov             rcx, BENCH_QWORDS
+                div             rcx
+                xor             rdx, rdx
+                mov             rcx, 100
+                div             rcx
+                push            rdx
+                call            print_qword
+                mov             al, '.'
+                call            write_char
+                pop             rax
+                xor             rdx, rdx
+                mov             rcx, 10
+                div             rcx
+                push            rdx
+                add             al, '0'
+                call            write_char
+                pop             rax
+                add             al, '0'
+                call            write_char
+                mov             rsi, ticks_msg
+                mov             rdx, ticks_msg_size
+                call            print_string
+                ret
+
+; write 64-bit number to stdout
+;    rax -- argument (64-bit unsigned)
+print_qword:
+                push            rax
+                mov             rax, 16
+                call            alloc
+                mov             rdi, rax
+                pop             rax
+                mov             [rdi], rax
+                xor             rcx, rcx
+                test            rax, rax
+                setnz           cl
+                call            write_long
+                ret
+
+                section         .rodata
+                align           8
+bench_sizes:    dq              8, 64, 512, 4096, 32768, 0
+add_name:
+                db              "add_long_long on "
+add_name_size:  equ             $ - add_name
+sub_name:
+                db              "sub_long_long on "
+sub_name_size:  equ             $ - sub_name
+qwords_msg:
+                db              " qwords: "
+qwords_msg_size: equ            $ - qwords_msg
+ticks_msg:
+                db              " ticks per qword", 0x0a
+ticks_msg_size: equ             $ - ticks_msg
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
@@ -0,0 +1,161 @@
+; Buffered stdin/stdout shared by add, sub and mul. Input is read and output
+; is written in blocks of IO_BUFFER_SIZE bytes, so that the number of
+; syscalls depends on the size of the data rather than on the number of
+; chars. Pending output is flushed by exit, so programs have to leave
+; through it.
+
+                section         .text
+
+                global          read_char
+                global          write_char
+                global          print_string
+                global          flush_output
+                global          exit
+
+; read one char from stdin
+; result:
+;    rax == -1 if error occurs or input is over
+;    rax \in [0; 255] if OK
+;    rcx and rdi are preserved
+read_char:
+                push            rcx
+                push            rdi
+
+                mov             rsi, [input_pos]
+                cmp             rsi, [input_end]
+                jb              .buffered
+
+                xor             rax, rax
+                xor             rdi, rdi
+                mov             rsi, input_buffer
+                mov             rdx, IO_BUFFER_SIZE
+                syscall
+
+                cmp             rax, 0
+                jle             .error
+                mov             rsi, input_buffer
+                lea             rdx, [rsi + rax]
+                mov             [input_end], rdx
+.buffered:
+                movzx           eax, byte [rsi]
+                inc             rsi
+                mov             [input_pos], rsi
+
+                pop             rdi
+                pop             rcx
+                ret
+.error:
+                mov             rax, -1
+                pop             rdi
+                pop             rcx
+                ret
+
+; write one char to stdout, errors are ignored
+;    al -- char
+; result:
+;    rax, rcx and rdi are preserved
+write_char:
+                mov             rsi, [output_size]
+                cmp             rsi, IO_BUFFER_SIZE
+                jb              .buffered
+                call            flush_output
+                xor             esi, esi
+.buffered:
+                mov             [output_buffer + rsi], al
+                inc             rsi
+                mov             [output_size], rsi
+                ret
+
+; print string to stdout, errors are ignored
+;    rsi -- string
+;    rdx -- size
+; result:
+;    rax, rcx and rdi are preserved
+print_string:
+                push            rax
+                push            rcx
+                push            rdi
+
+                mov             rax, [output_size]
+                lea             rcx, [rax + rdx]
+                cmp             rcx, IO_BUFFER_SIZE
+                jbe             .copy
+
+                push            rsi
+                push            rdx
+                call            flush_output
+                pop             rdx
+                pop             rsi
+                xor             eax, eax
+                cmp             rdx, IO_BUFFER_SIZE
+                jbe             .copy
+
+; the string does not fit in the buffer at all, so it is written directly
+                call            write_all
+                jmp             .done
+
+.copy:
+                lea             rdi, [output_buffer + rax]
+                add             rax, rdx
+                mov             [output_size], rax
+                mov             rcx, rdx
+                rep movsb
+
+.done:
+                pop             rdi
+                pop             rcx
+                pop             rax
+                ret
+
+; write the buffered output to stdout, errors are ignored
+; result:
+;    rax, rcx and rdi are preserved
+flush_output:
+                push            rax
+                push            rcx
+                push            rdi
+
+                mov             rsi, output_buffer
+                mov             rdx, [output_size]
+                call            write_all
+                mov             qword [output_size], 0
+
+                pop             rdi
+                pop             rcx
+                pop             rax
+                ret
+
+; write a whole string to stdout, retrying after partial writes
+;    rsi -- string
+;    rdx -- size
+write_all:
+.loop:
+                test            rdx, rdx
+                jz              .done
+                mov             rax, 1
+                mov             rdi, 1
+                syscall
+                cmp             rax, 0
+                jle             .done
+                add             rsi, rax
+                sub             rdx, rax
+                jmp             .loop
+.done:
+                ret
+
+exit:
+                call            flush_output
+                mov             rax, 60
+                xor             rdi, rdi
+                syscall
+
+IO_BUFFER_SIZE: equ             65536
+
+                section         .bss
+input_buffer:   resb            IO_BUFFER_SIZE
+output_buffer:  resb            IO_BUFFER_SIZE
+input_pos:      resq            1
+input_end:      resq            1
+output_size:    resq            1
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
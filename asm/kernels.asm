@@ -0,0 +1,343 @@
+; Limb kernels for little-endian arrays of 64-bit limbs, callable from C and
+; C++ through the System V ABI (see kernels.h). Only caller-saved registers
+; are used. Multiplications use MULX, which leaves the flags alone, so that
+; the carry chains of ADCX (CF) and ADOX (OF) survive across a whole row.
+; The loop counters are kept in rcx and tested with jrcxz for the same reason.
+; Callers have to check CPUID for BMI2 and ADX and pass n > 0.
+
+                section         .text
+
+                global          bigint_add_n
+                global          bigint_sub_n
+                global          bigint_mul_1
+                global          bigint_addmul_1
+                global          bigint_submul_1
+                global          bigint_lshift
+                global          bigint_rshift
+
+; adds two long numbers
+;    rdi -- address of the result
+;    rsi -- address of summand #1
+;    rdx -- address of summand #2
+;    rcx -- length of long numbers in qwords
+; result:
+;    sum is written to rdi
+;    rax -- carry
+bigint_add_n:
+                mov             r8, rcx
+                shr             rcx, 2
+                and             r8d, 3
+                clc
+                jrcxz           .tail
+.loop:
+                mov             rax, [rsi]
+                adc             rax, [rdx]
+                mov             [rdi], rax
+                mov             rax, [rsi + 8]
+                adc             rax, [rdx + 8]
+                mov             [rdi + 8], rax
+                mov             rax, [rsi + 16]
+                adc             rax, [rdx + 16]
+                mov             [rdi + 16], rax
+                mov             rax, [rsi + 24]
+                adc             rax, [rdx + 24]
+                mov             [rdi + 24], rax
+                lea             rsi, [rsi + 32]
+                lea             rdx, [rdx + 32]
+                lea             rdi, [rdi + 32]
+                dec             rcx
+                jnz             .loop
+.tail:
+                mov             rcx, r8
+                jrcxz           .done
+.tail_loop:
+                mov             rax, [rsi]
+                adc             rax, [rdx]
+                mov             [rdi], rax
+                lea             rsi, [rsi + 8]
+                lea             rdx, [rdx + 8]
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jnz             .tail_loop
+.done:
+                setc            al
+                movzx           eax, al
+                ret
+
+; subtracts two long numbers
+;    rdi -- address of the result
+;    rsi -- address of the minuend
+;    rdx -- address of the subtrahend
+;    rcx -- length of long numbers in qwords
+; result:
+;    difference is written to rdi
+;    rax -- borrow
+bigint_sub_n:
+                mov             r8, rcx
+                shr             rcx, 2
+                and             r8d, 3
+                clc
+                jrcxz           .tail
+.loop:
+                mov             rax, [rsi]
+                sbb             rax, [rdx]
+                mov             [rdi], rax
+                mov             rax, [rsi + 8]
+                sbb             rax, [rdx + 8]
+                mov             [rdi + 8], rax
+                mov             rax, [rsi + 16]
+                sbb             rax, [rdx + 16]
+                mov             [rdi + 16], rax
+                mov             rax, [rsi + 24]
+                sbb             rax, [rdx + 24]
+                mov             [rdi + 24], rax
+                lea             rsi, [rsi + 32]
+                lea             rdx, [rdx + 32]
+                lea             rdi, [rdi + 32]
+                dec             rcx
+                jnz             .loop
+.tail:
+                mov             rcx, r8
+                jrcxz           .done
+.tail_loop:
+                mov             rax, [rsi]
+                sbb             rax, [rdx]
+                mov             [rdi], rax
+                lea             rsi, [rsi + 8]
+                lea             rdx, [rdx + 8]
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jnz             .tail_loop
+.done:
+                setc            al
+                movzx           eax, al
+                ret
+
+; multiplies long number by a short
+;    rdi -- address of the result
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    product is written to rdi
+;    rax -- high limb of the product
+bigint_mul_1:
+                xchg            rdx, rcx
+                mov             r9, rcx
+                shr             r9, 2
+                and             ecx, 3
+                xor             r8d, r8d
+.single:
+                jrcxz           .unrolled
+                mulx            r11, r10, [rsi]
+                adcx            r10, r8
+                mov             [rdi], r10
+                mov             r8, r11
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                lea             rcx, [rcx - 1]
+                jmp             .single
+.unrolled:
+                mov             rcx, r9
+.loop:
+                jrcxz           .done
+                mulx            r11, r10, [rsi]
+                adcx            r10, r8
+                mov             [rdi], r10
+                mulx            r8, r10, [rsi + 8]
+                adcx            r10, r11
+                mov             [rdi + 8], r10
+                mulx            r11, r10, [rsi + 16]
+                adcx            r10, r8
+                mov             [rdi + 16], r10
+                mulx            r8, r10, [rsi + 24]
+                adcx            r10, r11
+                mov             [rdi + 24], r10
+                lea             rsi, [rsi + 32]
+                lea             rdi, [rdi + 32]
+                lea             rcx, [rcx - 1]
+                jmp             .loop
+.done:
+                mov             eax, 0
+                adcx            rax, r8
+                ret
+
+; adds a product of long number and a short to the result
+;    rdi -- address of the result (long number)
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rdi += rsi * rcx
+;    rax -- carry limb
+bigint_addmul_1:
+                xchg            rdx, rcx
+                mov             r9, rcx
+                shr             r9, 2
+                and             ecx, 3
+                xor             r8d, r8d
+.single:
+                jrcxz           .unrolled
+                mulx            r11, r10, [rsi]
+                adcx            r10, r8
+                adox            r10, [rdi]
+                mov             [rdi], r10
+                mov             r8, r11
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                lea             rcx, [rcx - 1]
+                jmp             .single
+.unrolled:
+                mov             rcx, r9
+.loop:
+                jrcxz           .done
+                mulx            r11, r10, [rsi]
+                adcx            r10, r8
+                adox            r10, [rdi]
+                mov             [rdi], r10
+                mulx            r8, r10, [rsi + 8]
+                adcx            r10, r11
+                adox            r10, [rdi + 8]
+                mov             [rdi + 8], r10
+                mulx            r11, r10, [rsi + 16]
+                adcx            r10, r8
+                adox            r10, [rdi + 16]
+                mov             [rdi + 16], r10
+                mulx            r8, r10, [rsi + 24]
+                adcx            r10, r11
+                adox            r10, [rdi + 24]
+                mov             [rdi + 24], r10
+                lea             rsi, [rsi + 32]
+                lea             rdi, [rdi + 32]
+                lea             rcx, [rcx - 1]
+                jmp             .loop
+.done:
+                mov             eax, 0
+                adcx            r8, rax
+                adox            r8, rax
+                mov             rax, r8
+                ret
+
+; subtracts a product of long number and a short from the result; the
+; product limbs are inverted and added on the OF chain, which starts at 1
+;    rdi -- address of the result (long number)
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long numbers in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rdi -= rsi * rcx
+;    rax -- borrow limb
+bigint_submul_1:
+                xchg            rdx, rcx
+                mov             r9, rcx
+                shr             r9, 2
+                and             ecx, 3
+                xor             r8d, r8d
+                mov             al, 0x7f
+                add             al, 1
+.single:
+                jrcxz           .unrolled
+                mulx            r11, r10, [rsi]
+                adcx            r10, r8
+                not             r10
+                adox            r10, [rdi]
+                mov             [rdi], r10
+                mov             r8, r11
+                lea             rsi, [rsi + 8]
+                lea             rdi, [rdi + 8]
+                lea             rcx, [rcx - 1]
+                jmp             .single
+.unrolled:
+                mov             rcx, r9
+.loop:
+                jrcxz           .done
+                mulx            r11, r10, [rsi]
+                adcx            r10, r8
+                not             r10
+                adox            r10, [rdi]
+                mov             [rdi], r10
+                mulx            r8, r10, [rsi + 8]
+                adcx            r10, r11
+                not             r10
+                adox            r10, [rdi + 8]
+                mov             [rdi + 8], r10
+                mulx            r11, r10, [rsi + 16]
+                adcx            r10, r8
+                not             r10
+                adox            r10, [rdi + 16]
+                mov             [rdi + 16], r10
+                mulx            r8, r10, [rsi + 24]
+                adcx            r10, r11
+                not             r10
+                adox            r10, [rdi + 24]
+                mov             [rdi + 24], r10
+                lea             rsi, [rsi + 32]
+                lea             rdi, [rdi + 32]
+                lea             rcx, [rcx - 1]
+                jmp             .loop
+.done:
+                mov             eax, 0
+                adcx            r8, rax
+                seto            al
+                xor             eax, 1
+                add             rax, r8
+                ret
+
+; shifts long number left by 1..63 bits, works from the top limb down
+;    rdi -- address of the result
+;    rsi -- address of the argument (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- shift
+; result:
+;    shifted number is written to rdi
+;    rax -- bits shifted out, in the low bits
+bigint_lshift:
+                mov             r9, rdx
+                mov             r10, [rsi + 8 * r9 - 8]
+                xor             eax, eax
+                shld            rax, r10, cl
+                dec             r9
+                jz              .last
+.loop:
+                mov             r11, [rsi + 8 * r9 - 8]
+                shld            r10, r11, cl
+                mov             [rdi + 8 * r9], r10
+                mov             r10, r11
+                dec             r9
+                jnz             .loop
+.last:
+                shl             r10, cl
+                mov             [rdi], r10
+                ret
+
+; shifts long number right by 1..63 bits, works from the low limb up
+;    rdi -- address of the result
+;    rsi -- address of the argument (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- shift
+; result:
+;    shifted number is written to rdi
+;    rax -- bits shifted out, in the high bits
+bigint_rshift:
+                mov             r10, [rsi]
+                xor             eax, eax
+                shrd            rax, r10, cl
+                lea             rsi, [rsi + 8 * rdx]
+                lea             rdi, [rdi + 8 * rdx - 8]
+                mov             r9, rdx
+                neg             r9
+                inc             r9
+                jz              .last
+.loop:
+                mov             r11, [rsi + 8 * r9]
+                shrd            r10, r11, cl
+                mov             [rdi + 8 * r9], r10
+                mov             r10, r11
+                inc             r9
+                jnz             .loop
+.last:
+                shr             r10, cl
+                mov             [rdi], r10
+                ret
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
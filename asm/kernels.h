@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Declarations of the kernels in kernels.asm. Limbs are 64-bit and
+// little-endian, n > 0, and the output may alias an input only when it
+// starts at the same address. The caller checks CPUID for BMI2 and ADX.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t bigint_add_n(uint64_t* r, uint64_t const* a, uint64_t const* b, size_t n);
+uint64_t bigint_sub_n(uint64_t* r, uint64_t const* a, uint64_t const* b, size_t n);
+uint64_t bigint_mul_1(uint64_t* r, uint64_t const* a, size_t n, uint64_t b);
+uint64_t bigint_addmul_1(uint64_t* r, uint64_t const* a, size_t n, uint64_t b);
+uint64_t bigint_submul_1(uint64_t* r, uint64_t const* a, size_t n, uint64_t b);
+// 0 < shift < 64
+uint64_t bigint_lshift(uint64_t* r, uint64_t const* a, size_t n, unsigned shift);
+uint64_t bigint_rshift(uint64_t* r, uint64_t const* a, size_t n, unsigned shift);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,503 @@
+; Long numbers shared by add, sub, mul and bench. A long number is an
+; address and a length in qwords, little-endian; the length counts
+; significant qwords only, so it is 0 for zero. The buffers are allocated on
+; the heap and sized to the input; routines that can lengthen a number need
+; room for one more qword.
+
+                section         .text
+
+                global          alloc
+                global          free_heap
+                global          read_long
+                global          write_long
+                global          add_long_long
+                global          sub_long_long
+                global          add_long_short
+                global          mul_long_short
+                global          div_long_short
+                global          set_zero
+                global          normalize
+
+                extern          read_char
+                extern          print_string
+                extern          write_char
+                extern          exit
+
+; allocates memory on the heap; consecutive allocations are adjacent, so
+; the last one can be grown by allocating more. The break is moved in steps
+; of HEAP_STEP bytes and is never moved back, memory is reused after
+; free_heap
+;    rax -- size in bytes
+; result:
+;    rax -- address of the memory, 8-byte aligned and not initialized
+alloc:
+                push            rcx
+                push            rdx
+                push            rdi
+
+                add             rax, 7
+                and             rax, -8
+                mov             rdx, [heap_end]
+                test            rdx, rdx
+                jnz             .allocate
+
+                push            rax
+                mov             rax, 12
+                xor             rdi, rdi
+                syscall
+                mov             rdx, rax
+                mov             [heap_start], rax
+                mov             [heap_limit], rax
+                pop             rax
+
+.allocate:
+                lea             rdi, [rdx + rax]
+                cmp             rdi, [heap_limit]
+                jbe             .done
+
+                push            rdi
+                add             rdi, HEAP_STEP - 1
+                and             rdi, -HEAP_STEP
+                mov             rax, 12
+                syscall
+                cmp             rax, rdi
+                jb              .out_of_memory
+                mov             [heap_limit], rdi
+                pop             rdi
+
+.done:
+                mov             [heap_end], rdi
+                mov             rax, rdx
+
+                pop             rdi
+                pop             rdx
+                pop             rcx
+                ret
+
+.out_of_memory:
+                mov             rsi, out_of_memory_msg
+                mov             rdx, out_of_memory_msg_size
+                call            print_string
+                jmp             exit
+
+; frees everything allocated on the heap
+free_heap:
+                push            rax
+
+                mov             rax, [heap_start]
+                mov             [heap_end], rax
+
+                pop             rax
+                ret
+
+; adds two long numbers, both must have room for one more qword; the
+; common part is added four qwords per iteration, the carry chain goes
+; through the whole loop
+;    rdi -- address of summand #1 (long number)
+;    rcx -- length of summand #1 in qwords
+;    rsi -- address of summand #2 (long number)
+;    rdx -- length of summand #2 in qwords
+; result:
+;    sum is written to the longer summand
+;    rdi -- address of the sum
+;    rcx -- length of the sum
+add_long_long:
+                cmp             rcx, rdx
+                jae             .ordered
+                xchg            rdi, rsi
+                xchg            rcx, rdx
+.ordered:
+                push            rcx
+                mov             r10, rdx
+                and             r10, 3
+                mov             rcx, rdx
+                shr             rcx, 2
+                xor             r9, r9
+                jrcxz           .tail
+.loop:
+                mov             rax, [rdi + 8 * r9]
+                adc             rax, [rsi + 8 * r9]
+                mov             [rdi + 8 * r9], rax
+                mov             rax, [rdi + 8 * r9 + 8]
+                adc             rax, [rsi + 8 * r9 + 8]
+                mov             [rdi + 8 * r9 + 8], rax
+                mov             rax, [rdi + 8 * r9 + 16]
+                adc             rax, [rsi + 8 * r9 + 16]
+                mov             [rdi + 8 * r9 + 16], rax
+                mov             rax, [rdi + 8 * r9 + 24]
+                adc             rax, [rsi + 8 * r9 + 24]
+                mov             [rdi + 8 * r9 + 24], rax
+                lea             r9, [r9 + 4]
+                dec             rcx
+                jnz             .loop
+.tail:
+                mov             rcx, r10
+                jrcxz           .carry
+.tail_loop:
+                mov             rax, [rdi + 8 * r9]
+                adc             rax, [rsi + 8 * r9]
+                mov             [rdi + 8 * r9], rax
+                lea             r9, [r9 + 1]
+                dec             rcx
+                jnz             .tail_loop
+
+; the carry goes on through the rest of the longer summand
+.carry:
+                pop             rcx
+                mov             eax, 0
+                adc             rax, 0
+                push            rdi
+                lea             rdi, [rdi + 8 * rdx]
+                sub             rcx, rdx
+                call            add_long_short
+                add             rcx, rdx
+                pop             rdi
+                ret
+
+; subtracts two long numbers, the minuend must not be less than the
+; subtrahend; the common part is subtracted four qwords per iteration, the
+; borrow chain goes through the whole loop
+;    rdi -- address of minuend (long number)
+;    rcx -- length of minuend in qwords
+;    rsi -- address of subtrahend (long number)
+;    rdx -- length of subtrahend in qwords
+; result:
+;    difference is written to rdi
+;    rcx -- length of the difference
+sub_long_long:
+                push            rcx
+                mov             r10, rdx
+                and             r10, 3
+                mov             rcx, rdx
+                shr             rcx, 2
+                xor             r9, r9
+                jrcxz           .tail
+.loop:
+                mov             rax, [rdi + 8 * r9]
+                sbb             rax, [rsi + 8 * r9]
+                mov             [rdi + 8 * r9], rax
+                mov             rax, [rdi + 8 * r9 + 8]
+                sbb             rax, [rsi + 8 * r9 + 8]
+                mov             [rdi + 8 * r9 + 8], rax
+                mov             rax, [rdi + 8 * r9 + 16]
+                sbb             rax, [rsi + 8 * r9 + 16]
+                mov             [rdi + 8 * r9 + 16], rax
+                mov             rax, [rdi + 8 * r9 + 24]
+                sbb             rax, [rsi + 8 * r9 + 24]
+                mov             [rdi + 8 * r9 + 24], rax
+                lea             r9, [r9 + 4]
+                dec             rcx
+                jnz             .loop
+.tail:
+                mov             rcx, r10
+                jrcxz           .borrow
+.tail_loop:
+                mov             rax, [rdi + 8 * r9]
+                sbb             rax, [rsi + 8 * r9]
+                mov             [rdi + 8 * r9], rax
+                lea             r9, [r9 + 1]
+                dec             rcx
+                jnz             .tail_loop
+
+; the borrow goes on through the rest of the minuend
+.borrow:
+                pop             rcx
+.borrow_loop:
+                jnc             .done
+                sbb             qword [rdi + 8 * r9], 0
+                lea             r9, [r9 + 1]
+                jmp             .borrow_loop
+
+.done:
+                call            normalize
+                ret
+
+; adds 64-bit number to long number
+;    rdi -- address of summand #1 (long number)
+;    rcx -- length of summand #1 in qwords
+;    rax -- summand #2 (64-bit unsigned)
+; result:
+;    sum is written to rdi
+;    rcx -- length of the sum
+add_long_short:
+                push            rdx
+
+                xor             rdx, rdx
+.loop:
+                cmp             rdx, rcx
+                je              .append
+                add             [rdi + 8 * rdx], rax
+                jnc             .done
+                mov             rax, 1
+                inc             rdx
+                jmp             .loop
+
+.append:
+                test            rax, rax
+                jz              .done
+                mov             [rdi + 8 * rcx], rax
+                inc             rcx
+
+.done:
+                pop             rdx
+                ret
+
+; multiplies long number by a short
+;    rdi -- address of multiplier #1 (long number)
+;    rcx -- length of multiplier #1 in qwords
+;    rbx -- multiplier #2 (64-bit unsigned)
+; result:
+;    product is written to rdi
+;    rcx -- length of the product
+mul_long_short:
+                push            rax
+                push            rdx
+
+                xor             rsi, rsi
+                xor             r9, r9
+.loop:
+                cmp             r9, rcx
+                je              .append
+                mov             rax, [rdi + 8 * r9]
+                mul             rbx
+                add             rax, rsi
+                adc             rdx, 0
+                mov             [rdi + 8 * r9], rax
+                mov             rsi, rdx
+                inc             r9
+                jmp             .loop
+
+.append:
+                test            rsi, rsi
+                jz              .done
+                mov             [rdi + 8 * rcx], rsi
+                inc             rcx
+
+.done:
+                pop             rdx
+                pop             rax
+                ret
+
+; divides long number by a short
+;    rdi -- address of dividend (long number)
+;    rcx -- length of dividend in qwords
+;    rbx -- divisor (64-bit unsigned, at least 2)
+; result:
+;    quotient is written to rdi
+;    rcx -- length of the quotient
+;    rdx -- remainder
+div_long_short:
+                push            rax
+                push            rsi
+
+                mov             rsi, rcx
+                xor             rdx, rdx
+.loop:
+                test            rsi, rsi
+                jz              .done
+                mov             rax, [rdi + 8 * rsi - 8]
+                div             rbx
+                mov             [rdi + 8 * rsi - 8], rax
+                dec             rsi
+                jmp             .loop
+
+.done:
+                call            normalize
+                pop             rsi
+                pop             rax
+                ret
+
+; assigns a zero to long number
+;    rdi -- argument (long number)
+;    rcx -- length of long number in qwords
+set_zero:
+                push            rax
+                push            rdi
+                push            rcx
+
+                xor             rax, rax
+                rep stosq
+
+                pop             rcx
+                pop             rdi
+                pop             rax
+                ret
+
+; drops the leading zero qwords of long number
+;    rdi -- argument (long number)
+;    rcx -- length of long number in qwords
+; result:
+;    rcx -- number of significant qwords
+normalize:
+                jrcxz           .done
+                cmp             qword [rdi + 8 * rcx - 8], 0
+                jne             .done
+                dec             rcx
+                jmp             normalize
+.done:
+                ret
+
+; read long number from stdin; its buffer is the last allocation and grows
+; while digits are read, leaving room for one more qword. Digits are
+; gathered in chunks of up to 19, which fit in a qword, so the number is
+; multiplied once per chunk rather than once per digit
+; result:
+;    rdi -- address of the number
+;    rcx -- length of the number in qwords
+read_long:
+                push            r8
+                push            r12
+                push            r13
+
+                xor             rax, rax
+                call            alloc
+                mov             rdi, rax
+                xor             rcx, rcx
+                xor             r8, r8
+.chunk:
+; a chunk adds at most one qword, and one more has to stay free
+                lea             rax, [rcx + 2]
+                cmp             rax, r8
+                jbe             .read
+
+; the capacity in r8 is doubled, starting from 64 qwords
+                mov             rax, r8
+                cmp             rax, 64
+                jae             .grow
+                mov             rax, 64
+.grow:
+                add             r8, rax
+                shl             rax, 3
+                call            alloc
+
+.read:
+                xor             r12, r12
+                xor             r13, r13
+.digit:
+                call            read_char
+                or              rax, rax
+                js              exit
+                cmp             rax, 0x0a
+                je              .last_chunk
+                cmp             rax, '0'
+                jb              .invalid_char
+                cmp             rax, '9'
+                ja              .invalid_char
+
+                sub             rax, '0'
+                imul            r12, r12, 10
+                add             r12, rax
+                inc             r13
+                cmp             r13, 19
+                jb              .digit
+
+                call            .append_chunk
+                jmp             .chunk
+
+.last_chunk:
+                test            r13, r13
+                jz              .done
+                call            .append_chunk
+.done:
+                pop             r13
+                pop             r12
+                pop             r8
+                ret
+
+; number = number * 10^r13 + r12
+.append_chunk:
+                mov             rbx, [powers_of_ten + 8 * r13]
+                call            mul_long_short
+                mov             rax, r12
+                call            add_long_short
+                ret
+
+.invalid_char:
+                mov             rsi, invalid_char_msg
+                mov             rdx, invalid_char_msg_size
+                call            print_string
+                call            write_char
+                mov             al, 0x0a
+                call            write_char
+
+.skip_loop:
+                call            read_char
+                or              rax, rax
+                js              exit
+                cmp             rax, 0x0a
+                je              exit
+                jmp             .skip_loop
+
+; write long number to stdout, the number is destroyed. It is divided by
+; 10^19 at a time, and each remainder gives 19 digits; only the leading
+; chunk is printed without its leading zeros
+;    rdi -- argument (long number)
+;    rcx -- length of long number in qwords
+write_long:
+                push            rax
+                push            rcx
+
+; a qword takes at most 20 digits, and zero takes one
+                lea             rax, [rcx + 4 * rcx]
+                lea             rax, [4 * rax + 1]
+                mov             rbp, rax
+                call            alloc
+                add             rbp, rax
+
+                mov             rsi, rbp
+                mov             rbx, [powers_of_ten + 8 * 19]
+                mov             r10, 10
+.chunk:
+                call            div_long_short
+                mov             rax, rdx
+                mov             r9, 19
+.digit:
+                xor             rdx, rdx
+                div             r10
+                add             dl, '0'
+                dec             rsi
+                mov             [rsi], dl
+                test            rcx, rcx
+                jnz             .next_digit
+                test            rax, rax
+                jz              .print
+.next_digit:
+                dec             r9
+                jnz             .digit
+                jmp             .chunk
+
+.print:
+                mov             rdx, rbp
+                sub             rdx, rsi
+                call            print_string
+
+                pop             rcx
+                pop             rax
+                ret
+
+                section         .rodata
+invalid_char_msg:
+                db              "Invalid character: "
+invalid_char_msg_size: equ             $ - invalid_char_msg
+out_of_memory_msg:
+                db              "Out of memory", 0x0a
+out_of_memory_msg_size: equ             $ - out_of_memory_msg
+
+                align           8
+; 10^k for k in [0; 19], the last one only fits as unsigned
+powers_of_ten:
+                dq              1, 10, 100, 1000, 10000, 100000, 1000000
+                dq              10000000, 100000000, 1000000000, 10000000000
+                dq              100000000000, 1000000000000, 10000000000000
+                dq              100000000000000, 1000000000000000
+                dq              10000000000000000, 100000000000000000
+                dq              1000000000000000000, 0x8ac7230489e80000
+
+HEAP_STEP:      equ             65536
+
+                section         .bss
+heap_start:     resq            1
+heap_end:       resq            1
+heap_limit:     resq            1
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
@@ -0,0 +1,533 @@
+                section         .text
+
+                global          _start
+
+                extern          alloc
+                extern          read_long
+                extern          write_long
+                extern          add_long_short
+                extern          set_zero
+                extern          normalize
+                extern          write_char
+                extern          free_heap
+                extern          exit
+
+; reads pairs of numbers until the input is over and writes a line with the
+; result for each pair
+_start:
+                call            free_heap
+                call            read_long
+                push            rdi
+                push            rcx
+                call            read_long
+                pop             rdx
+                pop             rsi
+                call            mul_long_long
+
+                call            write_long
+
+                mov             al, 0x0a
+                call            write_char
+
+                jmp             _start
+
+; operands of at least KARATSUBA_THRESHOLD qwords are multiplied by
+; Karatsuba's method, smaller ones by the schoolbook one
+KARATSUBA_THRESHOLD: equ       64
+
+; multiplies two long numbers
+;    rdi -- address of multiplier #1 (long number)
+;    rcx -- length of multiplier #1 in qwords
+;    rsi -- address of multiplier #2 (long number)
+;    rdx -- length of multiplier #2 in qwords
+; result:
+;    product is written to a new buffer
+;    rdi -- address of the product
+;    rcx -- length of the product
+mul_long_long:
+                push            r8
+                push            r15
+
+                lea             rax, [rcx + rdx]
+                shl             rax, 3
+                call            alloc
+                mov             r8, rax
+
+; scratch space for mul_any, see there; the schoolbook method needs none
+                mov             rax, rcx
+                cmp             rax, rdx
+                jbe             .scratch
+                mov             rax, rdx
+.scratch:
+                cmp             rax, KARATSUBA_THRESHOLD
+                jb              .multiply
+                shl             rax, 5
+                add             rax, 65536
+                shl             rax, 3
+                call            alloc
+                mov             r15, rax
+
+.multiply:
+                call            mul_any
+
+                mov             rdi, r8
+                add             rcx, rdx
+                call            normalize
+
+                pop             r15
+                pop             r8
+                ret
+
+; multiplies two raw numbers of any lengths; the longer one is cut into
+; pieces as long as the shorter one, which are multiplied by mul_n, and the
+; leftover piece is multiplied recursively. Scratch space takes less than
+; 32 qwords per qword of the shorter multiplier, plus 65536 qwords
+;    r8 -- address of the result (rcx + rdx qwords)
+;    rdi -- address of multiplier #1
+;    rcx -- length of multiplier #1 in qwords
+;    rsi -- address of multiplier #2
+;    rdx -- length of multiplier #2 in qwords
+;    r15 -- address of scratch space
+; result:
+;    product is written to r8
+;    all registers but rax are preserved
+mul_any:
+                push            rbx
+                push            rcx
+                push            rdx
+                push            rdi
+                push            rsi
+                push            r8
+                push            r9
+                push            r10
+                push            r11
+                push            r12
+                push            r15
+
+                cmp             rcx, rdx
+                jae             .ordered
+                xchg            rdi, rsi
+                xchg            rcx, rdx
+.ordered:
+                cmp             rdx, KARATSUBA_THRESHOLD
+                jae             .pieces
+                call            mul_basecase
+                jmp             .done
+
+.pieces:
+                push            rdi
+                push            rcx
+                mov             rdi, r8
+                add             rcx, rdx
+                call            set_zero
+                pop             rcx
+                pop             rdi
+
+; r9 -- offset of the piece, r10 -- its length, r11 -- product of the
+; piece, r12 -- length of that product, rbx -- length of the result from r9
+                mov             r11, r15
+                lea             rax, [rdx + rdx]
+                lea             r15, [r15 + 8 * rax]
+                xor             r9, r9
+.piece:
+                cmp             r9, rcx
+                jae             .done
+                mov             r10, rcx
+                sub             r10, r9
+                cmp             r10, rdx
+                jb              .leftover
+
+                push            r8
+                push            rdi
+                push            rcx
+                mov             r8, r11
+                lea             rdi, [rdi + 8 * r9]
+                mov             rcx, rdx
+                call            mul_n
+                pop             rcx
+                pop             rdi
+                pop             r8
+                lea             r12, [rdx + rdx]
+                mov             r10, rdx
+                jmp             .accumulate
+
+.leftover:
+                push            r8
+                push            rdi
+                push            rcx
+                mov             r8, r11
+                lea             rdi, [rdi + 8 * r9]
+                mov             rcx, r10
+                call            mul_any
+                pop             rcx
+                pop             rdi
+                pop             r8
+                lea             r12, [rdx + r10]
+
+; result[r9..] += product of the piece, the carry cannot leave the result
+.accumulate:
+                push            rdi
+                push            rsi
+                push            rdx
+                push            rcx
+                lea             rbx, [rcx + rdx]
+                sub             rbx, r9
+                lea             rdi, [r8 + 8 * r9]
+                mov             rsi, rdi
+                mov             rdx, r11
+                mov             rcx, r12
+                call            add_n
+                lea             rdi, [rdi + 8 * r12]
+                mov             rcx, rbx
+                sub             rcx, r12
+                call            add_long_short
+                pop             rcx
+                pop             rdx
+                pop             rsi
+                pop             rdi
+
+                add             r9, r10
+                jmp             .piece
+
+.done:
+                pop             r15
+                pop             r12
+                pop             r11
+                pop             r10
+                pop             r9
+                pop             r8
+                pop             rsi
+                pop             rdi
+                pop             rdx
+                pop             rcx
+                pop             rbx
+                ret
+
+; multiplies two raw numbers of the same length by Karatsuba's method,
+;    (a1 B + a0)(b1 B + b0) = z2 B^2 + (z0 + z2 - (a0 - a1)(b0 - b1)) B + z0
+; for z0 = a0 b0 and z2 = a1 b1, where B = 2^(64 m) and m = ceil(n / 2).
+; This level takes 6 m + 1 qwords of scratch space and the levels below take
+; the space after it, less than 6 n + 512 qwords in total
+;    r8 -- address of the result (2 * rcx qwords)
+;    rdi -- address of multiplier #1
+;    rsi -- address of multiplier #2
+;    rcx -- length of multipliers in qwords
+;    r15 -- address of scratch space
+; result:
+;    product is written to r8
+;    all registers but rax are preserved
+mul_n:
+                cmp             rcx, KARATSUBA_THRESHOLD
+                jae             .karatsuba
+                push            rdx
+                mov             rdx, rcx
+                call            mul_basecase
+                pop             rdx
+                ret
+
+.karatsuba:
+                push            rbx
+                push            rcx
+                push            rdx
+                push            rdi
+                push            rsi
+                push            r8
+                push            r9
+                push            r10
+                push            r11
+                push            r12
+                push            r13
+                push            r14
+                push            r15
+
+; rbx -- m, r9 -- 8 m, r12 -- n - m, r13 -- multiplier #1,
+; r14 -- multiplier #2, r10 -- result,
+; r11 -- 1 if exactly one of a0 - a1 and b0 - b1 is negative
+                mov             r13, rdi
+                mov             r14, rsi
+                mov             r10, r8
+                lea             rbx, [rcx + 1]
+                shr             rbx, 1
+                mov             r12, rcx
+                sub             r12, rbx
+                lea             r9, [8 * rbx]
+
+; z0 to result[0..2m), z2 to result[2m..2n)
+                mov             rcx, rbx
+                call            mul_n
+                lea             r8, [r10 + 2 * r9]
+                lea             rdi, [r13 + 8 * rbx]
+                lea             rsi, [r14 + 8 * rbx]
+                mov             rcx, r12
+                call            mul_n
+
+; |a0 - a1| to scratch[0..m), |b0 - b1| to scratch[m..2m)
+                mov             rdi, r15
+                mov             rsi, r13
+                call            abs_diff
+                mov             r11, rax
+                lea             rdi, [r15 + 8 * rbx]
+                mov             rsi, r14
+                call            abs_diff
+                xor             r11, rax
+
+; their product to scratch[2m..4m)
+                lea             r8, [r15 + 2 * r9]
+                mov             rdi, r15
+                lea             rsi, [r15 + 8 * rbx]
+                mov             rcx, rbx
+                lea             rax, [rbx + 2 * rbx]
+                lea             rax, [2 * rax + 1]
+                push            r15
+                lea             r15, [r15 + 8 * rax]
+                call            mul_n
+                pop             r15
+
+; z0 + z2 to scratch[4m..6m + 1)
+                lea             rdi, [r15 + 4 * r9]
+                mov             rsi, r10
+                lea             rcx, [rbx + rbx]
+                rep movsq
+                mov             qword [rdi], 0
+                lea             rdi, [r15 + 4 * r9]
+                mov             rsi, rdi
+                lea             rdx, [r10 + 2 * r9]
+                lea             rcx, [r12 + r12]
+                call            add_n
+                lea             rdi, [rdi + 8 * rcx]
+                mov             rcx, rbx
+                sub             rcx, r12
+                shl             rcx, 1
+                call            add_long_short
+
+; minus or plus the product of the differences, which leaves a0 b1 + a1 b0
+                lea             rdi, [r15 + 4 * r9]
+                mov             rsi, rdi
+                lea             rdx, [r15 + 2 * r9]
+                lea             rcx, [rbx + rbx]
+                test            r11, r11
+                jnz             .add_middle
+                call            sub_n
+                sub             [rdi + 8 * rcx], rax
+                jmp             .middle
+.add_middle:
+                call            add_n
+                add             [rdi + 8 * rcx], rax
+
+; result[m..2n) += middle term, the carry cannot leave the result
+.middle:
+                lea             rdi, [r10 + 8 * rbx]
+                mov             rsi, rdi
+                lea             rdx, [r15 + 4 * r9]
+                lea             rcx, [2 * rbx + 1]
+                call            add_n
+                lea             rdi, [rdi + 8 * rcx]
+                lea             rcx, [r12 + r12]
+                sub             rcx, rbx
+                dec             rcx
+                call            add_long_short
+
+                pop             r15
+                pop             r14
+                pop             r13
+                pop             r12
+                pop             r11
+                pop             r10
+                pop             r9
+                pop             r8
+                pop             rsi
+                pop             rdi
+                pop             rdx
+                pop             rcx
+                pop             rbx
+                ret
+
+; absolute difference of the halves of a raw number, as used by mul_n
+;    rdi -- address of the difference (rbx qwords)
+;    rsi -- address of the number, low half of rbx qwords, high of r12
+;    rbx -- length of the low half, r12 <= rbx <= r12 + 1
+; result:
+;    rax -- 1 if the high half is greater, 0 otherwise
+abs_diff:
+                push            rcx
+                push            rdx
+                push            rdi
+                push            rsi
+
+; the high half, zero-extended to rbx qwords
+                push            rsi
+                push            rdi
+                lea             rsi, [rsi + 8 * rbx]
+                mov             rcx, r12
+                rep movsq
+                mov             rcx, rbx
+                sub             rcx, r12
+                xor             rax, rax
+                rep stosq
+                pop             rdi
+                pop             rsi
+
+                mov             rdx, rdi
+                mov             rcx, rbx
+                call            cmp_n
+                jb              .negative
+                call            sub_n
+                xor             rax, rax
+                jmp             .done
+.negative:
+                xchg            rsi, rdx
+                call            sub_n
+                mov             rax, 1
+
+.done:
+                pop             rsi
+                pop             rdi
+                pop             rdx
+                pop             rcx
+                ret
+
+; multiplies two raw numbers, one row of multiplier #1 by a qword of
+; multiplier #2 at a time; zero qwords of multiplier #2 are skipped
+;    r8 -- address of the result (rcx + rdx qwords)
+;    rdi -- address of multiplier #1
+;    rcx -- length of multiplier #1 in qwords
+;    rsi -- address of multiplier #2
+;    rdx -- length of multiplier #2 in qwords
+; result:
+;    product is written to r8
+;    all registers but rax are preserved
+mul_basecase:
+                push            rbx
+                push            rdx
+                push            r9
+                push            r10
+                push            r11
+                push            r12
+                push            r13
+
+                mov             r13, rdx
+
+                push            rdi
+                push            rcx
+                mov             rdi, r8
+                add             rcx, r13
+                call            set_zero
+                pop             rcx
+                pop             rdi
+
+                xor             r9, r9
+.row:
+                cmp             r9, r13
+                jae             .done
+                mov             rbx, [rsi + 8 * r9]
+                test            rbx, rbx
+                jz              .next_row
+                lea             r10, [r8 + 8 * r9]
+                xor             r11, r11
+                xor             r12, r12
+.column:
+                cmp             r12, rcx
+                jae             .row_done
+                mov             rax, [rdi + 8 * r12]
+                mul             rbx
+                add             rax, r11
+                adc             rdx, 0
+                add             [r10 + 8 * r12], rax
+                adc             rdx, 0
+                mov             r11, rdx
+                inc             r12
+                jmp             .column
+.row_done:
+                mov             [r10 + 8 * rcx], r11
+.next_row:
+                inc             r9
+                jmp             .row
+
+.done:
+                pop             r13
+                pop             r12
+                pop             r11
+                pop             r10
+                pop             r9
+                pop             rdx
+                pop             rbx
+                ret
+
+; adds two raw numbers, the sum may overwrite a summand
+;    rdi -- address of the sum
+;    rsi -- address of summand #1
+;    rdx -- address of summand #2
+;    rcx -- length of raw numbers in qwords
+; result:
+;    rax -- carry
+add_n:
+                push            rcx
+                push            r9
+
+                xor             r9, r9
+                jrcxz           .done
+.loop:
+                mov             rax, [rsi + 8 * r9]
+                adc             rax, [rdx + 8 * r9]
+                mov             [rdi + 8 * r9], rax
+                lea             r9, [r9 + 1]
+                dec             rcx
+                jnz             .loop
+.done:
+                mov             eax, 0
+                adc             rax, 0
+
+                pop             r9
+                pop             rcx
+                ret
+
+; subtracts two raw numbers, the difference may overwrite an operand
+;    rdi -- address of the difference
+;    rsi -- address of the minuend
+;    rdx -- address of the subtrahend
+;    rcx -- length of raw numbers in qwords
+; result:
+;    rax -- borrow
+sub_n:
+                push            rcx
+                push            r9
+
+                xor             r9, r9
+                jrcxz           .done
+.loop:
+                mov             rax, [rsi + 8 * r9]
+                sbb             rax, [rdx + 8 * r9]
+                mov             [rdi + 8 * r9], rax
+                lea             r9, [r9 + 1]
+                dec             rcx
+                jnz             .loop
+.done:
+                mov             eax, 0
+                adc             rax, 0
+
+                pop             r9
+                pop             rcx
+                ret
+
+; compares two raw numbers
+;    rsi -- address of raw number #1
+;    rdx -- address of raw number #2
+;    rcx -- length of raw numbers in qwords
+; result:
+;    CF=1 if number #1 is less, ZF=1 if they are equal
+cmp_n:
+                push            rcx
+.loop:
+                jrcxz           .equal
+                mov             rax, [rsi + 8 * rcx - 8]
+                cmp             rax, [rdx + 8 * rcx - 8]
+                jne             .done
+                dec             rcx
+                jmp             .loop
+.equal:
+                xor             eax, eax
+.done:
+                pop             rcx
+                ret
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
@@ -0,0 +1,33 @@
+                section         .text
+
+                global          _start
+
+                extern          read_long
+                extern          write_long
+                extern          sub_long_long
+                extern          write_char
+                extern          free_heap
+                extern          exit
+
+; reads pairs of numbers until the input is over and writes a line with the
+; result for each pair
+_start:
+                call            free_heap
+                call            read_long
+                push            rdi
+                push            rcx
+                call            read_long
+                mov             rsi, rdi
+                mov             rdx, rcx
+                pop             rcx
+                pop             rdi
+                call            sub_long_long
+
+                call            write_long
+
+                mov             al, 0x0a
+                call            write_char
+
+                jmp             _start
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
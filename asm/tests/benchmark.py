@@ -0,0 +1,55 @@
+import argparse
+import os
+import random
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+# Benchmark of the asm programs on large operands. Inputs are generated once
+# per size, before any timing, and every program is run several times on
+# each of them; the median latency and the throughput in input digits per
+# second are reported.
+
+if hasattr(sys, 'set_int_max_str_digits'):
+    sys.set_int_max_str_digits(0)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--build', default=os.path.join('..', 'build'), help='directory with the executables')
+parser.add_argument('--programs', nargs='+', default=['add', 'sub', 'mul'])
+parser.add_argument('--bits', nargs='+', type=int, default=[1000, 10000, 100000, 1000000],
+                    help='operand sizes in bits')
+parser.add_argument('--runs', type=int, default=5, help='runs per program and size')
+parser.add_argument('--seed', type=int, default=0)
+args = parser.parse_args()
+
+random.seed(args.seed)
+operations = {'add': lambda x, y: x + y, 'sub': lambda x, y: x - y, 'mul': lambda x, y: x * y}
+
+with tempfile.TemporaryDirectory() as directory:
+    inputs = []
+    for bits in args.bits:
+        x = random.getrandbits(bits) | 1 << (bits - 1)
+        y = random.getrandbits(bits) | 1 << (bits - 1)
+        x, y = max(x, y), min(x, y)
+        path = os.path.join(directory, '{}.txt'.format(bits))
+        with open(path, 'w') as file:
+            file.write('{}\n{}\n'.format(x, y))
+        inputs.append((bits, path, x, y, os.path.getsize(path) - 2))
+
+    print('{:>8} {:>10} {:>14} {:>16}'.format('program', 'bits', 'median, ms', 'digits/s'))
+    for program in args.programs:
+        executable = os.path.join(args.build, program)
+        for bits, path, x, y, digits in inputs:
+            expected = str(operations[program](x, y))
+            latencies = []
+            for _ in range(args.runs):
+                with open(path) as stdin:
+                    start = time.perf_counter()
+                    result = subprocess.run([executable], stdin=stdin, stdout=subprocess.PIPE, check=True)
+                    latencies.append(time.perf_counter() - start)
+                if result.stdout.decode().strip() != expected:
+                    sys.exit('{} gives a wrong result on {} bits'.format(program, bits))
+            median = statistics.median(latencies)
+            print('{:>8} {:>10} {:>14.3f} {:>16.0f}'.format(program, bits, median * 1000, digits / median))
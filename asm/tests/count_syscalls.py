@@ -0,0 +1,45 @@
+import ctypes
+import os
+import sys
+
+# Runs a program under ptrace, like `strace -c`, and prints the number of
+# read, write and all syscalls it made to stderr. The program inherits
+# stdin and stdout. Only x86-64 Linux is supported.
+
+PTRACE_TRACEME = 0
+PTRACE_PEEKUSER = 3
+PTRACE_SYSCALL = 24
+PTRACE_SETOPTIONS = 0x4200
+PTRACE_O_TRACESYSGOOD = 1
+ORIG_RAX_OFFSET = 15 * 8
+
+SYS_READ = 0
+SYS_WRITE = 1
+
+libc = ctypes.CDLL(None, use_errno=True)
+libc.ptrace.restype = ctypes.c_long
+libc.ptrace.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_void_p, ctypes.c_void_p]
+
+pid = os.fork()
+if pid == 0:
+    libc.ptrace(PTRACE_TRACEME, 0, None, None)
+    os.execv(sys.argv[1], sys.argv[1:])
+
+os.waitpid(pid, 0)
+libc.ptrace(PTRACE_SETOPTIONS, pid, None, PTRACE_O_TRACESYSGOOD)
+counts = {}
+entering = True
+while True:
+    libc.ptrace(PTRACE_SYSCALL, pid, None, None)
+    _, status = os.waitpid(pid, 0)
+    if os.WIFEXITED(status) or os.WIFSIGNALED(status):
+        break
+    if os.WSTOPSIG(status) != (0x80 | 5):
+        continue
+    if entering:
+        number = libc.ptrace(PTRACE_PEEKUSER, pid, ORIG_RAX_OFFSET, None)
+        counts[number] = counts.get(number, 0) + 1
+    entering = not entering
+
+print('read: {} write: {} total: {}'.format(
+    counts.get(SYS_READ, 0), counts.get(SYS_WRITE, 0), sum(counts.values())), file=sys.stderr)
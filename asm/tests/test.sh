@@ -7,11 +7,41 @@ else
     sort=1
 fi
 
+if [[ -n $BATCH ]]; then
+    rm -f input.txt expected.txt
+    for number in $(seq 1 ${TESTS:-68})
+    do
+        python3 generate.py $number $sort >> input.txt
+        cat output.txt >> expected.txt
+        echo >> expected.txt
+    done
+    time=$(date +%s%N | cut -b1-13)
+    ../build/$EXEC < input.txt > result.txt
+    time=$(($(date +%s%N | cut -b1-13) - $time))
+    if cmp -s result.txt expected.txt; then
+        rm input.txt expected.txt output.txt result.txt
+        echo "Tests passed in one run in $time miliseconds"
+    else
+        echo "Batch run failed, the first differing lines:"
+        diff result.txt expected.txt | head -4 | cut -b1-200
+        exit 1
+    fi
+    exit 0
+fi
+
+total_syscalls=0
 time=$(date +%s%N | cut -b1-13)
-for number in {1..68}
+for number in $(seq 1 ${TESTS:-68})
 do
     python3 generate.py $number $sort > input.txt
-    result=$(cat input.txt | ../build/$EXEC)
+    if [[ -n $SYSCALLS ]]; then
+        result=$(python3 count_syscalls.py ../build/$EXEC < input.txt 2> syscalls.txt)
+        echo "Test $number syscalls: $(cat syscalls.txt)"
+        total_syscalls=$((total_syscalls + $(awk '{print $6}' syscalls.txt)))
+        rm syscalls.txt
+    else
+        result=$(cat input.txt | ../build/$EXEC)
+    fi
     for line in $(cat output.txt) 
     do
         if [[ "$line" == "$result" ]]; then
@@ -26,4 +56,7 @@ do
         fi
     done
 done
+if [[ -n $SYSCALLS ]]; then
+    echo "Syscalls in total: $total_syscalls"
+fi
 echo "Tests passed in $(($(date +%s%N | cut -b1-13) - $time)) miliseconds"
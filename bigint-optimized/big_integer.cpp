@@ -1,4 +1,5 @@
 #include "big_integer.h"
+#include "limb_kernels.h"
 
 #include <cstring>
 #include <stdexcept>
@@ -35,6 +36,7 @@ big_integer::big_integer(std::string const& str) : big_integer() {
 }
 
 void big_integer::sum_unsigned(big_integer const &rhs) {
+    add_leading_zeros(rhs.size());
     uint64_t carry = 0;
     for (size_t i = 0; i < size(); i++) {
         uint64_t const res = static_cast<uint64_t>(digits[i]) + rhs.kth_digit(i) + carry;
@@ -66,6 +68,9 @@ void big_integer::sub_from_bigger(big_integer const &rhs, bool less) {
 }
 
 big_integer& big_integer::operator+=(big_integer const& rhs) {
+    if (fits_64() && rhs.fits_64() && add_64(rhs.low_64(), rhs.sign)) {
+        return *this;
+    }
     if (sign == rhs.sign) {
         sum_unsigned(rhs);
     } else {
@@ -78,6 +83,9 @@ big_integer& big_integer::operator+=(big_integer const& rhs) {
 }
 
 big_integer& big_integer::operator-=(big_integer const& rhs) {
+    if (fits_64() && rhs.fits_64() && add_64(rhs.low_64(), !rhs.sign)) {
+        return *this;
+    }
     if (sign != rhs.sign) {
         sum_unsigned(rhs);
     } else {
@@ -90,23 +98,30 @@ big_integer& big_integer::operator-=(big_integer const& rhs) {
 }
 
 big_integer& big_integer::operator*=(big_integer const& rhs) {
-    big_integer ans;
-    ans.sign = sign ^ rhs.sign;
-    ans.add_leading_zeros(size() + rhs.size());
-    for (size_t i = 0; i < size(); i++) {
-        uint64_t carry = 0;
-        for (size_t j = 0; j < rhs.size(); j++) {
-            uint64_t const res = static_cast<uint64_t>(digits[i])
-                    * rhs.kth_digit(j)
-                    + carry
-                    + ans.digits[i + j];
-            ans.digits[i + j] = res;
-            carry = res >> 32u;
+    if (fits_64() && rhs.fits_64()) {
+        uint128_t const product = static_cast<uint128_t>(low_64()) * rhs.low_64();
+        bool const negative = sign ^ rhs.sign;
+        if ((product >> 64u) == 0) {
+            assign_64(static_cast<uint64_t>(product), negative);
+        } else {
+            uint32_t const limbs[] = {static_cast<uint32_t>(product), static_cast<uint32_t>(product >> 32u),
+                                      static_cast<uint32_t>(product >> 64u), static_cast<uint32_t>(product >> 96u)};
+            assign_magnitude(limbs, 4, negative);
         }
-        ans.digits[i + rhs.size()] += carry;
+        return *this;
     }
-    ans.erase_leading_zeros();
-    return *this = ans;
+    optimized_vector const& a = digits;
+    optimized_vector result(size() + rhs.size());
+    if (a.begin() == rhs.digits.begin()) {
+        // x *= x, or two copies sharing one buffer
+        sqr(result.begin(), a.begin(), size());
+    } else {
+        mul(result.begin(), a.begin(), size(), rhs.digits.begin(), rhs.size());
+    }
+    sign ^= rhs.sign;
+    digits.swap(result);
+    erase_leading_zeros();
+    return *this;
 }
 
 big_integer big_integer::div_short(big_integer const& a, uint32_t const divider) {
@@ -139,18 +154,11 @@ bool big_integer::smaller(const big_integer &a, const big_integer &b, size_t idx
     return false;
 }
 
-void big_integer::difference(big_integer &a, const big_integer &b, size_t idx) {
-    size_t start = a.size() - idx;
-    uint64_t res = (static_cast<uint64_t>(a.kth_digit(start + 1)) << 32u) | a.kth_digit(start);
-    for (size_t i = 0; i < idx; i++) {
-        res -= b.kth_digit(i);
-        a.digits[start + i] = res;
-        res >>= 32u;
-        res |= static_cast<uint64_t>(a.kth_digit(start + i + 2) - (res > a.kth_digit(start + i + 1))) << 32u;
-    }
-}
-
 big_integer& big_integer::operator/=(big_integer const& rhs) {
+    if (fits_64() && rhs.fits_64()) {
+        assign_64(low_64() / rhs.low_64(), sign ^ rhs.sign);
+        return *this;
+    }
     big_integer ans;
     if (size() < rhs.size()) {
         return *this = ans;
@@ -166,15 +174,22 @@ big_integer& big_integer::operator/=(big_integer const& rhs) {
         size_t const n = dividend.size();
         size_t const m = divisor.size() + 1;
         ans.add_leading_zeros(n - m + 1);
+        optimized_vector const& d = divisor.digits;
         for (size_t i = 0; i <= n - m; i++) {
             uint32_t res = trial(dividend, divisor);
-            big_integer multiple = divisor * res;
-            while (smaller(dividend, multiple, m)) {
+            // top m limbs of the dividend -= divisor * res, while that goes
+            // below zero the estimate was too large and divisor is added back
+            uint32_t* window = dividend.digits.begin() + (dividend.size() - m);
+            uint32_t const high = submul_1(window, d.begin(), m - 1, res);
+            bool negative = window[m - 1] < high;
+            window[m - 1] -= high;
+            while (negative) {
                 res--;
-                multiple -= divisor;
+                uint64_t const top = static_cast<uint64_t>(window[m - 1]) + add_n(window, window, d.begin(), m - 1);
+                window[m - 1] = static_cast<uint32_t>(top);
+                negative = (top >> 32u) == 0;
             }
             ans.digits[n - m - i] = res;
-            difference(dividend, multiple, m);
             if (dividend.digits.back() == 0) {
                 dividend.digits.pop_back();
             }
@@ -186,6 +201,10 @@ big_integer& big_integer::operator/=(big_integer const& rhs) {
 }
 
 big_integer& big_integer::operator%=(big_integer const& rhs) {
+    if (fits_64() && rhs.fits_64()) {
+        assign_64(low_64() % rhs.low_64(), sign);
+        return *this;
+    }
     return *this = *this - *this / rhs * rhs;
 }
 
@@ -193,56 +212,80 @@ void big_integer::to_add2(size_t length) {
     add_leading_zeros(length);
     if (sign) {
         sign = false;
-        for (uint32_t &digit : digits) {
-            digit = ~digit;
-        }
+        com_n(digits.begin(), digits.begin(), size());
         (*this)++;
     }
 }
 
-big_integer big_integer::bit_operation(big_integer const& rhs, const std::function<uint32_t(uint32_t, uint32_t)>& operation) {
+big_integer big_integer::bit_operation(big_integer const& rhs, void (*kernel)(uint32_t*, uint32_t const*, uint32_t const*, size_t)) {
     big_integer this_copy(*this),
     rhs_copy(rhs);
     size_t len = std::max(this_copy.size(), rhs_copy.size());
     this_copy.to_add2(len);
     rhs_copy.to_add2(len);
-    this_copy.sign = operation(sign, rhs.sign);
-    for (size_t i = 0; i < len; i++) {
-        this_copy.digits[i] = operation(this_copy.digits[i], rhs_copy.digits[i]);
-    }
+    // the signs stand for the infinitely many bits above len limbs
+    uint32_t const signs[2] = {sign, rhs.sign};
+    uint32_t result_sign;
+    kernel(&result_sign, signs, signs + 1, 1);
+    optimized_vector const& b = rhs_copy.digits;
+    kernel(this_copy.digits.begin(), this_copy.digits.begin(), b.begin(), len);
+    this_copy.sign = result_sign != 0;
     if (this_copy.sign) {
         this_copy.to_add2(len);
         this_copy.sign = true;
     }
+    this_copy.erase_leading_zeros();
     return this_copy;
 }
 
 big_integer& big_integer::operator&=(big_integer const& rhs) {
-    return *this = bit_operation(rhs, [](uint32_t a, uint32_t b) { return a & b; });
+    return *this = bit_operation(rhs, and_n);
 }
 
 big_integer& big_integer::operator|=(big_integer const& rhs) {
-    return *this = bit_operation(rhs, [](uint32_t a, uint32_t b) { return a | b; });
+    return *this = bit_operation(rhs, ior_n);
 }
 
 big_integer& big_integer::operator^=(big_integer const& rhs) {
-    return *this = bit_operation(rhs, [](uint32_t a, uint32_t b) { return a ^ b; });
+    return *this = bit_operation(rhs, xor_n);
 }
 
 big_integer& big_integer::operator<<=(int rhs) {
-    *this *= big_integer(static_cast<uint32_t>(1) << (rhs % 32u));
-    digits.insert(digits.begin(), rhs / 32, 0);
+    if (digits.back() == 0) {
+        return *this;
+    }
+    size_t const limbs = rhs / 32;
+    unsigned const bits = rhs % 32;
+    optimized_vector const& a = digits;
+    optimized_vector result(size() + limbs + 1);
+    if (bits == 0) {
+        std::copy(a.begin(), a.end(), result.begin() + limbs);
+    } else {
+        result[size() + limbs] = lshift(result.begin() + limbs, a.begin(), size(), bits);
+    }
+    digits.swap(result);
+    erase_leading_zeros();
     return *this;
 }
 
 big_integer& big_integer::operator>>=(int rhs) {
-    *this /= big_integer(static_cast<uint32_t>(1) << (rhs % 32u));
-    digits.erase(digits.begin(), digits.begin() + std::min(rhs / 32ul, size()));
-    if (digits.empty()) {
-        digits = {0};
+    size_t const limbs = rhs / 32;
+    unsigned const bits = rhs % 32;
+    if (limbs >= size()) {
+        digits = optimized_vector(1);
         sign = false;
+        return *this;
     }
-    return sign? --*this : *this;
+    optimized_vector const& a = digits;
+    optimized_vector result(size() - limbs);
+    if (bits == 0) {
+        std::copy(a.begin() + limbs, a.end(), result.begin());
+    } else {
+        rshift(result.begin(), a.begin() + limbs, size() - limbs, bits);
+    }
+    digits.swap(result);
+    erase_leading_zeros();
+    return sign ? --*this : *this;
 }
 
 big_integer big_integer::operator+() const {
@@ -258,19 +301,9 @@ big_integer big_integer::operator-() const {
 }
 
 big_integer big_integer::operator~() const {
-    big_integer rev(*this);
-    if (rev.digits.back() == 0) {
-        rev.digits.back() = 1;
-        rev.sign = true;
-    } else {
-        rev.sign ^= true;
-        size_t i = 0;
-        while (rev.digits[i] == (rev.sign ? UINT32_MAX : 0)) {
-            rev.digits[i] = (rev.sign ? 0 : UINT32_MAX);
-        }
-        rev.digits[i] += (rev.sign ? 1 : -1);
-    }
-    return rev;
+    // ~x = -x - 1
+    big_integer rev = -*this;
+    return --rev;
 }
 
 big_integer& big_integer::operator++() {
@@ -345,7 +378,7 @@ big_integer operator>>(big_integer a, int b)
 
 bool operator==(big_integer const& a, big_integer const& b)
 {
-    return (a.sign == b.sign && a.digits == b.digits);
+    return a.sign == b.sign && a.size() == b.size() && equal_n(a.digits.begin(), b.digits.begin(), a.size());
 }
 
 bool operator!=(big_integer const& a, big_integer const& b)
@@ -360,13 +393,9 @@ bool operator<(big_integer const& a, big_integer const& b)
     } else if (a.size() != b.size()) {
         return ((a.sign && a.size() > b.size()) || (!a.sign && a.size() < b.size()));
     } else {
-        for (ptrdiff_t i = a.size() - 1; i >= 0; --i) {
-            if (a.digits[i] != b.digits[i]) {
-                return (a.digits[i] < b.digits[i]) ^ a.sign;
-            }
-        }
+        int const cmp = cmp_n(a.digits.begin(), b.digits.begin(), a.size());
+        return cmp != 0 && ((cmp < 0) ^ a.sign);
     }
-    return false;
 }
 
 bool operator>(big_integer const& a, big_integer const& b)
@@ -406,6 +435,59 @@ uint32_t big_integer::kth_digit(size_t idx) const {
     return (idx < size() ? digits[idx] : 0);
 }
 
+size_t big_integer::bit_length() const {
+    size_t bits = 32 * (size() - 1);
+    for (uint32_t top = digits.back(); top != 0; top >>= 1u) {
+        bits++;
+    }
+    return bits;
+}
+
+// values of at most two limbs take the native 64-bit paths of the arithmetic
+// operators and never reach the limb loops unless the result overflows
+bool big_integer::fits_64() const {
+    return size() <= 2;
+}
+
+uint64_t big_integer::low_64() const {
+    return static_cast<uint64_t>(kth_digit(1)) << 32u | digits[0];
+}
+
+void big_integer::assign_64(uint64_t magnitude, bool negative) {
+    optimized_vector result(1 + (magnitude > UINT32_MAX), static_cast<uint32_t>(magnitude));
+    if (magnitude > UINT32_MAX) {
+        result[1] = static_cast<uint32_t>(magnitude >> 32u);
+    }
+    digits.swap(result);
+    sign = negative && magnitude != 0;
+}
+
+// this += (negative ? -magnitude : magnitude), false if the sum needs more
+// than 64 bits and nothing was changed
+bool big_integer::add_64(uint64_t magnitude, bool negative) {
+    uint64_t const a = low_64();
+    if (sign == negative) {
+        uint64_t const sum = a + magnitude;
+        if (sum < a) {
+            return false;
+        }
+        assign_64(sum, sign);
+    } else if (a >= magnitude) {
+        assign_64(a - magnitude, sign);
+    } else {
+        assign_64(magnitude - a, negative);
+    }
+    return true;
+}
+
+void big_integer::assign_magnitude(uint32_t const* limbs, size_t length, bool negative) {
+    optimized_vector result(std::max(length, static_cast<size_t>(1)));
+    std::copy_n(limbs, length, result.begin());
+    digits.swap(result);
+    sign = negative;
+    erase_leading_zeros();
+}
+
 std::string to_string(big_integer const& a) {
     if (a == 0) {
         return "0";
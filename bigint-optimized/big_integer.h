@@ -7,6 +7,12 @@
 #include <algorithm>
 #include <functional>
 
+// helpers private to one translation unit that need the limbs of big_integer
+namespace detail {
+struct gcd_engine;
+struct lucas_test;
+}
+
 struct big_integer {
     big_integer();
     big_integer(big_integer const& other) = default;
@@ -49,6 +55,23 @@ struct big_integer {
 
     friend std::string to_string(big_integer const& a);
 
+    friend void batch_add(big_integer const*, big_integer const*, big_integer*, size_t, size_t);
+    friend void batch_mul(big_integer const*, big_integer const*, big_integer*, size_t, size_t);
+    friend void batch_mod(big_integer const*, big_integer const*, big_integer*, size_t, size_t);
+    friend big_integer product(big_integer const*, big_integer const*, size_t);
+    friend big_integer powmod(big_integer, big_integer const&, big_integer const&);
+    friend struct modulus_context;
+    friend struct detail::gcd_engine;
+    friend big_integer gcd(big_integer, big_integer);
+    friend big_integer lcm(big_integer const&, big_integer const&);
+    friend big_integer extended_gcd(big_integer const&, big_integer const&, big_integer&, big_integer&);
+    friend big_integer pow(big_integer const&, uint32_t);
+    friend big_integer iroot(big_integer const&, uint32_t);
+    friend bool is_perfect_square(big_integer const&);
+    friend struct detail::lucas_test;
+    friend bool is_probable_prime(big_integer const&);
+    friend big_integer next_prime(big_integer const&);
+
 private:
     using uint128_t = unsigned __int128;
 
@@ -59,14 +82,20 @@ private:
     void add_leading_zeros(size_t);
     void erase_leading_zeros();
     uint32_t kth_digit(size_t const) const;
+    size_t bit_length() const;
+    bool fits_64() const;
+    uint64_t low_64() const;
+    void assign_64(uint64_t magnitude, bool negative);
+    bool add_64(uint64_t magnitude, bool negative);
+    void assign_magnitude(uint32_t const* limbs, size_t length, bool negative);
+    static big_integer product_tree(big_integer const* first, big_integer const* last, size_t const* prefix, size_t threads);
 
     void to_add2(size_t);
-    big_integer bit_operation(big_integer const& rhs, const std::function<uint32_t(uint32_t, uint32_t)>&);
+    big_integer bit_operation(big_integer const& rhs, void (*kernel)(uint32_t*, uint32_t const*, uint32_t const*, size_t));
 
     static big_integer div_short(big_integer const&, uint32_t const);
     uint32_t trial(big_integer const&, big_integer const&);
     bool smaller(big_integer const&, big_integer const&, size_t);
-    void difference(big_integer&, big_integer const&, size_t);
     void sum_unsigned(big_integer const &rhs);
     void sub_from_bigger(big_integer const &rhs, bool less);
 };
@@ -92,5 +121,52 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
+// result[i] = lhs[i] op rhs[i] for i < count; result may be lhs or rhs.
+// Work is split into contiguous chunks over the given number of threads.
+void batch_add(big_integer const* lhs, big_integer const* rhs, big_integer* result, size_t count, size_t threads = 1);
+void batch_mul(big_integer const* lhs, big_integer const* rhs, big_integer* result, size_t count, size_t threads = 1);
+void batch_mod(big_integer const* lhs, big_integer const* rhs, big_integer* result, size_t count, size_t threads = 1);
+
+// product of [first, last) by a balanced product tree, so that operands of
+// every multiplication have similar length; subtrees may run on separate threads
+big_integer product(big_integer const* first, big_integer const* last, size_t threads = 1);
+
+// n! by the prime swing recursion, the power of two is applied as a shift
+big_integer factorial(uint32_t n);
+big_integer binomial(uint32_t n, uint32_t k);
+// product of all primes not exceeding n
+big_integer primorial(uint32_t n);
+
+// base^exp mod mod in [0, mod) for exp >= 0 and mod > 0, using Montgomery
+// multiplication and a sliding window when mod is odd
+big_integer powmod(big_integer base, big_integer const& exp, big_integer const& mod);
+
+// Lehmer's algorithm on two leading limbs at a time, with a half-gcd
+// recursion once operands are long enough; results are non-negative
+big_integer gcd(big_integer a, big_integer b);
+big_integer lcm(big_integer const& a, big_integer const& b);
+// returns gcd(a, b) and sets x, y such that a * x + b * y = gcd(a, b)
+big_integer extended_gcd(big_integer const& a, big_integer const& b, big_integer& x, big_integer& y);
+// inverse of a modulo mod in [0, mod), throws if gcd(a, mod) != 1
+big_integer modinv(big_integer const& a, big_integer const& mod);
+
+// base^exp by a left-to-right sliding window; trailing zero bits of the base
+// are stripped and applied as one shift at the end
+big_integer pow(big_integer const& base, uint32_t exp);
+
+// floor of the k-th root by Newton's iteration, refined from a root of the
+// leading half; negative a is allowed for odd k and rounds towards zero
+big_integer iroot(big_integer const& a, uint32_t k);
+big_integer isqrt(big_integer const& a);
+bool is_perfect_square(big_integer const& a);
+
+// strong probable prime test of n to the given base
+bool miller_rabin(big_integer const& n, big_integer const& base);
+// Baillie-PSW: trial division by the product of small primes, Miller-Rabin to
+// base 2 and a strong Lucas test; exact below 2^64, no composite is known to pass
+bool is_probable_prime(big_integer const& n);
+// smallest probable prime greater than n, candidates are sieved in windows
+big_integer next_prime(big_integer const& n);
+
 std::string to_string(big_integer const& a);
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
@@ -0,0 +1,256 @@
+#include "big_integer.h"
+#include "limb_kernels.h"
+
+#include <thread>
+#include <vector>
+
+// Reference counts of shared digit buffers are not atomic, so worker threads
+// never copy, assign or destroy a big_integer that is visible outside of them.
+// They read operand limbs and write into one shared arena; the results are
+// materialized on the calling thread afterwards.
+
+namespace {
+template <typename F>
+void run_chunks(size_t count, size_t threads, F const& work) {
+    threads = std::max(static_cast<size_t>(1), std::min(threads, count));
+    if (threads == 1) {
+        work(0, count);
+        return;
+    }
+    size_t const chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> pool;
+    for (size_t first = chunk; first < count; first += chunk) {
+        pool.emplace_back(work, first, std::min(count, first + chunk));
+    }
+    work(0, chunk);
+    for (std::thread& t : pool) {
+        t.join();
+    }
+}
+
+int compare_magnitudes(uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
+    }
+    return cmp_n(a, b, an);
+}
+
+// r[0, dn) = a mod d for a divisor of at least two limbs with a nonzero top
+// limb, by schoolbook division on a normalized copy kept in scratch, which
+// holds an + dn + 1 limbs
+void mod_n(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* d, size_t dn, uint32_t* scratch) {
+    if (an < dn) {
+        std::copy(a, a + an, r);
+        std::fill(r + an, r + dn, 0);
+        return;
+    }
+    if (dn == 2 && an == 2) {
+        uint64_t const x = (static_cast<uint64_t>(a[1]) << 32u) | a[0];
+        uint64_t const y = (static_cast<uint64_t>(d[1]) << 32u) | d[0];
+        uint64_t const rem = x % y;
+        r[0] = static_cast<uint32_t>(rem);
+        r[1] = static_cast<uint32_t>(rem >> 32u);
+        return;
+    }
+    unsigned const shift = __builtin_clz(d[dn - 1]);
+    uint32_t* u = scratch;
+    uint32_t* v = scratch + an + 1;
+    if (shift == 0) {
+        std::copy(a, a + an, u);
+        u[an] = 0;
+        std::copy(d, d + dn, v);
+    } else {
+        u[an] = lshift(u, a, an, shift);
+        lshift(v, d, dn, shift);
+    }
+    uint64_t const top = v[dn - 1], next = v[dn - 2];
+    for (size_t j = an - dn + 1; j-- > 0;) {
+        uint32_t* w = u + j;
+        // estimate from the top two limbs, corrected by the third, is at
+        // most one too large
+        uint64_t const head = (static_cast<uint64_t>(w[dn]) << 32u) | w[dn - 1];
+        uint64_t q = head / top, rem = head % top;
+        while (q > UINT32_MAX || q * next > ((rem << 32u) | w[dn - 2])) {
+            q--;
+            rem += top;
+            if (rem > UINT32_MAX) {
+                break;
+            }
+        }
+        uint32_t const high = submul_1(w, v, dn, static_cast<uint32_t>(q));
+        bool negative = w[dn] < high;
+        w[dn] -= high;
+        while (negative) {
+            uint64_t const sum = static_cast<uint64_t>(w[dn]) + add_n(w, w, v, dn);
+            w[dn] = static_cast<uint32_t>(sum);
+            negative = (sum >> 32u) == 0;
+        }
+    }
+    if (shift == 0) {
+        std::copy(u, u + dn, r);
+    } else {
+        rshift(r, u, dn, shift);
+    }
+}
+
+struct batch_output {
+    explicit batch_output(size_t count) : offset(count + 1), negative(count) {}
+
+    void allocate() {
+        arena.assign(offset.back(), 0);
+    }
+
+    uint32_t* limbs(size_t i) {
+        return arena.data() + offset[i];
+    }
+
+    size_t length(size_t i) const {
+        return offset[i + 1] - offset[i];
+    }
+
+    // result i occupies arena[offset[i], offset[i + 1])
+    std::vector<size_t> offset;
+    std::vector<char> negative;
+    std::vector<uint32_t> arena;
+};
+
+// |lng| + |sht| where lng has at least as many limbs as sht
+struct magnitude_sum {
+    uint32_t const* lng;
+    size_t ln;
+    uint32_t const* sht;
+    size_t sn;
+    uint32_t* r;
+
+    void finish(size_t from, uint32_t carry) const {
+        carry = add_n(r + from, lng + from, sht + from, sn - from, carry);
+        r[ln] = add_1(r + sn, lng + sn, ln - sn, carry);
+    }
+};
+}
+
+void batch_add(big_integer const* lhs, big_integer const* rhs, big_integer* result, size_t count, size_t threads) {
+    batch_output out(count);
+    for (size_t i = 0; i < count; i++) {
+        out.offset[i + 1] = out.offset[i] + std::max(lhs[i].size(), rhs[i].size()) + 1;
+    }
+    out.allocate();
+    run_chunks(count, threads, [&](size_t first, size_t last) {
+        magnitude_sum pending{};
+        bool has_pending = false;
+        for (size_t i = first; i < last; i++) {
+            big_integer const* a = lhs + i;
+            big_integer const* b = rhs + i;
+            if (compare_magnitudes(a->digits.begin(), a->size(), b->digits.begin(), b->size()) < 0) {
+                std::swap(a, b);
+            }
+            uint32_t* r = out.limbs(i);
+            out.negative[i] = a->sign;
+            if (a->sign != b->sign) {
+                uint32_t const borrow = sub_n(r, a->digits.begin(), b->digits.begin(), b->size());
+                sub_1(r + b->size(), a->digits.begin() + b->size(), a->size() - b->size(), borrow);
+                continue;
+            }
+            magnitude_sum current{a->digits.begin(), a->size(), b->digits.begin(), b->size(), r};
+            if (!has_pending) {
+                pending = current;
+                has_pending = true;
+                continue;
+            }
+            // independent same-sign sums go through the kernel in pairs
+            size_t const common = std::min(pending.sn, current.sn);
+            uint32_t carry0 = 0, carry1 = 0;
+            add_n_x2(pending.r, pending.lng, pending.sht, carry0,
+                     current.r, current.lng, current.sht, carry1, common);
+            pending.finish(common, carry0);
+            current.finish(common, carry1);
+            has_pending = false;
+        }
+        if (has_pending) {
+            pending.finish(0, 0);
+        }
+    });
+    for (size_t i = 0; i < count; i++) {
+        result[i].assign_magnitude(out.limbs(i), out.length(i), out.negative[i]);
+    }
+}
+
+void batch_mul(big_integer const* lhs, big_integer const* rhs, big_integer* result, size_t count, size_t threads) {
+    batch_output out(count);
+    for (size_t i = 0; i < count; i++) {
+        out.offset[i + 1] = out.offset[i] + lhs[i].size() + rhs[i].size();
+    }
+    out.allocate();
+    run_chunks(count, threads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            mul(out.limbs(i), lhs[i].digits.begin(), lhs[i].size(), rhs[i].digits.begin(), rhs[i].size());
+            out.negative[i] = lhs[i].sign ^ rhs[i].sign;
+        }
+    });
+    for (size_t i = 0; i < count; i++) {
+        result[i].assign_magnitude(out.limbs(i), out.length(i), out.negative[i]);
+    }
+}
+
+void batch_mod(big_integer const* lhs, big_integer const* rhs, big_integer* result, size_t count, size_t threads) {
+    batch_output out(count);
+    for (size_t i = 0; i < count; i++) {
+        out.offset[i + 1] = out.offset[i] + rhs[i].size();
+    }
+    out.allocate();
+    run_chunks(count, threads, [&](size_t first, size_t last) {
+        // one scratch buffer per worker, sized for its longest division
+        size_t longest = 0;
+        for (size_t i = first; i < last; i++) {
+            if (rhs[i].size() > 1) {
+                longest = std::max(longest, lhs[i].size() + rhs[i].size() + 1);
+            }
+        }
+        std::vector<uint32_t> scratch(longest);
+        for (size_t i = first; i < last; i++) {
+            out.negative[i] = lhs[i].sign;
+            if (rhs[i].size() == 1) {
+                out.limbs(i)[0] = mod_1(lhs[i].digits.begin(), lhs[i].size(), rhs[i].digits[0]);
+                continue;
+            }
+            mod_n(out.limbs(i), lhs[i].digits.begin(), lhs[i].size(), rhs[i].digits.begin(), rhs[i].size(),
+                  scratch.data());
+        }
+    });
+    for (size_t i = 0; i < count; i++) {
+        result[i].assign_magnitude(out.limbs(i), out.length(i), out.negative[i]);
+    }
+}
+
+big_integer big_integer::product_tree(big_integer const* first, big_integer const* last, size_t const* prefix, size_t threads) {
+    size_t const n = last - first;
+    if (n == 1) {
+        big_integer copy;
+        copy.assign_magnitude(first->digits.begin(), first->size(), first->sign);
+        return copy;
+    }
+    // split where half of the limbs are on each side
+    size_t const* middle = std::lower_bound(prefix + 1, prefix + n, (prefix[0] + prefix[n] + 1) / 2);
+    size_t const mid = std::min(static_cast<size_t>(middle - prefix), n - 1);
+    if (threads < 2) {
+        return product_tree(first, first + mid, prefix, 1) *= product_tree(first + mid, last, prefix + mid, 1);
+    }
+    big_integer left;
+    std::thread worker([&] {
+        left = product_tree(first, first + mid, prefix, threads / 2);
+    });
+    big_integer right = product_tree(first + mid, last, prefix + mid, threads - threads / 2);
+    worker.join();
+    return left *= right;
+}
+
+big_integer product(big_integer const* first, big_integer const* last, size_t threads) {
+    if (first == last) {
+        return 1;
+    }
+    std::vector<size_t> prefix(last - first + 1);
+    for (size_t i = 0; first + i != last; i++) {
+        prefix[i + 1] = prefix[i] + first[i].size();
+    }
+    return big_integer::product_tree(first, last, prefix.data(), threads);
+}
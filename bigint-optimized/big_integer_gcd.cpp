@@ -0,0 +1,294 @@
+#include "big_integer.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+size_t const HGCD_THRESHOLD = 160;
+size_t const HGCD_BASECASE_BITS = 32 * HGCD_THRESHOLD;
+
+__extension__ typedef __int128 int128_t;
+
+big_integer to_big(uint64_t value) {
+    big_integer result(static_cast<uint32_t>(value >> 32u));
+    result <<= 32;
+    return result += static_cast<uint32_t>(value);
+}
+
+struct matrix2 {
+    matrix2() : m11(1), m12(0), m21(0), m22(1) {}
+
+    // this = this * rhs
+    void multiply(matrix2 const& rhs) {
+        big_integer n11 = m11 * rhs.m11 + m12 * rhs.m21, n12 = m11 * rhs.m12 + m12 * rhs.m22;
+        big_integer n21 = m21 * rhs.m11 + m22 * rhs.m21, n22 = m21 * rhs.m12 + m22 * rhs.m22;
+        m11 = n11;
+        m12 = n12;
+        m21 = n21;
+        m22 = n22;
+    }
+
+    big_integer m11, m12, m21, m22;
+};
+
+// E(q_1) ... E(q_k) for E(q) = [[q, 1], [1, 0]], so that (a, b) = M (alpha, beta)
+// when q_1, ..., q_k are the first quotients of Euclid's algorithm on (a, b)
+struct quotient_matrix : matrix2 {
+    std::vector<big_integer> q;
+
+    bool odd() const {
+        return q.size() % 2 == 1;
+    }
+
+    void push(big_integer const& quotient) {
+        big_integer t = m11 * quotient + m12;
+        m12 = m11;
+        m11 = t;
+        t = m21 * quotient + m22;
+        m22 = m21;
+        m21 = t;
+        q.push_back(quotient);
+    }
+
+    // drops the last quotient, (alpha, beta) are moved back accordingly
+    void pop(big_integer& alpha, big_integer& beta) {
+        big_integer const& quotient = q.back();
+        m11 -= quotient * m12;
+        std::swap(m11, m12);
+        m21 -= quotient * m22;
+        std::swap(m21, m22);
+        beta += quotient * alpha;
+        std::swap(alpha, beta);
+        q.pop_back();
+    }
+
+    void append(quotient_matrix const& rhs) {
+        multiply(rhs);
+        q.insert(q.end(), rhs.q.begin(), rhs.q.end());
+    }
+
+    // (alpha, beta) = M^-1 (a, b), det M = (-1)^k
+    void apply_inverse(big_integer const& a, big_integer const& b, big_integer& alpha, big_integer& beta) const {
+        alpha = m22 * a - m12 * b;
+        beta = m11 * b - m21 * a;
+        if (odd()) {
+            alpha = -alpha;
+            beta = -beta;
+        }
+    }
+};
+}
+
+namespace detail {
+// Euclid's algorithm on a >= b >= 0, optionally tracking U with
+// (a0, b0) = U (a, b) for the original operands.
+struct gcd_engine {
+    gcd_engine(big_integer const& a_, big_integer const& b_, bool track_)
+            : a(a_), b(b_), track(track_), det_negative(false) {}
+
+    void run() {
+        while (b != 0) {
+            quotient_matrix m;
+            if (b.size() >= HGCD_THRESHOLD && a != b) {
+                big_integer alpha, beta;
+                hgcd(a, b, m, alpha, beta);
+                a = alpha;
+                b = beta;
+            } else if (a.size() > 2) {
+                lehmer_step(m, a, b, 0);
+            }
+            if (m.q.empty()) {
+                euclid_step(m, a, b);
+            }
+            if (track) {
+                u.multiply(m);
+                det_negative ^= m.odd();
+            }
+        }
+    }
+
+    // g = det U * (u22 a0 - u12 b0)
+    void bezout(big_integer& x, big_integer& y) const {
+        x = det_negative ? -u.m22 : u.m22;
+        y = det_negative ? u.m12 : -u.m12;
+    }
+
+    big_integer a, b;
+
+private:
+    bool const track;
+    matrix2 u;
+    bool det_negative;
+
+    // floor(x / 2^shift) mod 2^64
+    static uint64_t bits_at(big_integer const& x, size_t shift) {
+        size_t const idx = shift / 32;
+        big_integer::uint128_t const window = static_cast<big_integer::uint128_t>(x.kth_digit(idx))
+                | static_cast<big_integer::uint128_t>(x.kth_digit(idx + 1)) << 32u
+                | static_cast<big_integer::uint128_t>(x.kth_digit(idx + 2)) << 64u;
+        return static_cast<uint64_t>(window >> (shift % 32));
+    }
+
+    static void euclid_step(quotient_matrix& m, big_integer& alpha, big_integer& beta) {
+        big_integer q = alpha / beta;
+        big_integer r = alpha - q * beta;
+        m.push(q);
+        alpha = beta;
+        beta = r;
+    }
+
+    // One pass of Lehmer's algorithm on the leading 63 bits, i.e. two limbs at
+    // a time, of alpha >= beta. Quotients are taken only while both bounds agree
+    // and while beta is estimated to stay above 2^stop_bits.
+    static void lehmer_step(quotient_matrix& m, big_integer& alpha, big_integer& beta, size_t stop_bits) {
+        size_t const n = alpha.bit_length();
+        size_t const shift = n > 63 ? n - 63 : 0;
+        int128_t const stop = stop_bits > shift ? static_cast<int128_t>(1) << std::min(stop_bits - shift, static_cast<size_t>(64)) : 0;
+        int128_t x = bits_at(alpha, shift), y = bits_at(beta, shift);
+        int128_t A = 1, B = 0, C = 0, D = 1;
+        std::vector<uint64_t> quotients;
+        while (y + C > 0 && y + D > 0 && x + A >= 0 && x + B >= 0) {
+            int128_t const q = (x + A) / (y + C);
+            if (q != (x + B) / (y + D)) {
+                break;
+            }
+            int128_t t = x - q * y;
+            if (t < stop) {
+                break;
+            }
+            x = y;
+            y = t;
+            t = A - q * C;
+            A = C;
+            C = t;
+            t = B - q * D;
+            B = D;
+            D = t;
+            quotients.push_back(static_cast<uint64_t>(q));
+        }
+        if (quotients.empty()) {
+            return;
+        }
+        // (alpha, beta) = [[A, B], [C, D]] (alpha, beta), whose inverse is the
+        // quotient matrix [[|D|, |B|], [|C|, |A|]]
+        bool const odd = quotients.size() % 2 == 1;
+        big_integer const a_abs = to_big(static_cast<uint64_t>(A < 0 ? -A : A));
+        big_integer const b_abs = to_big(static_cast<uint64_t>(B < 0 ? -B : B));
+        big_integer const c_abs = to_big(static_cast<uint64_t>(C < 0 ? -C : C));
+        big_integer const d_abs = to_big(static_cast<uint64_t>(D < 0 ? -D : D));
+        big_integer next_alpha = odd ? beta * b_abs - alpha * a_abs : alpha * a_abs - beta * b_abs;
+        beta = odd ? alpha * c_abs - beta * d_abs : beta * d_abs - alpha * c_abs;
+        alpha = next_alpha;
+
+        quotient_matrix step;
+        step.m11 = d_abs;
+        step.m12 = b_abs;
+        step.m21 = c_abs;
+        step.m22 = a_abs;
+        for (uint64_t q : quotients) {
+            step.q.push_back(to_big(q));
+        }
+        m.append(step);
+    }
+
+    // Half-gcd on a > b > 0 with n = a.bit_length(): finds a prefix M of the
+    // quotient sequence with (a, b) = M (alpha, beta) and beta close to
+    // 2^(n/2). Matrices computed from leading bits are checked against the
+    // full operands and trailing quotients are dropped until alpha > beta > 0.
+    static void hgcd(big_integer const& a, big_integer const& b, quotient_matrix& m,
+                     big_integer& alpha, big_integer& beta) {
+        size_t const n = a.bit_length();
+        size_t const s = n / 2 + 1;
+        alpha = a;
+        beta = b;
+        if (n >= HGCD_BASECASE_BITS) {
+            reduce_by_leading_bits(m, alpha, beta, n / 2);
+            if (beta.bit_length() > s) {
+                euclid_step(m, alpha, beta);
+            }
+            size_t const rest = alpha.bit_length();
+            if (beta.bit_length() > s && 2 * s > rest) {
+                reduce_by_leading_bits(m, alpha, beta, 2 * s - rest);
+            }
+        }
+        while (beta.bit_length() > s) {
+            size_t const before = m.q.size();
+            if (alpha.size() > 2) {
+                lehmer_step(m, alpha, beta, s);
+            }
+            if (m.q.size() == before) {
+                euclid_step(m, alpha, beta);
+            }
+        }
+    }
+
+    static void reduce_by_leading_bits(quotient_matrix& m, big_integer& alpha, big_integer& beta, size_t shift) {
+        big_integer const high_a = alpha >> static_cast<int>(shift);
+        big_integer const high_b = beta >> static_cast<int>(shift);
+        if (high_b == 0 || high_a <= high_b) {
+            return;
+        }
+        quotient_matrix r;
+        big_integer x, y;
+        hgcd(high_a, high_b, r, x, y);
+        r.apply_inverse(alpha, beta, x, y);
+        while (!r.q.empty() && !(x > y && y > 0)) {
+            r.pop(x, y);
+        }
+        if (r.q.empty()) {
+            return;
+        }
+        alpha = x;
+        beta = y;
+        m.append(r);
+    }
+};
+}
+
+big_integer gcd(big_integer a, big_integer b) {
+    a.sign = b.sign = false;
+    detail::gcd_engine engine(std::max(a, b), std::min(a, b), false);
+    engine.run();
+    return engine.a;
+}
+
+big_integer lcm(big_integer const& a, big_integer const& b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    big_integer result = a / gcd(a, b) * b;
+    result.sign = false;
+    return result;
+}
+
+big_integer extended_gcd(big_integer const& a, big_integer const& b, big_integer& x, big_integer& y) {
+    big_integer a_abs = a, b_abs = b;
+    a_abs.sign = b_abs.sign = false;
+    bool const swapped = a_abs < b_abs;
+    detail::gcd_engine engine(swapped ? b_abs : a_abs, swapped ? a_abs : b_abs, true);
+    engine.run();
+    engine.bezout(swapped ? y : x, swapped ? x : y);
+    if (a.sign) {
+        x = -x;
+    }
+    if (b.sign) {
+        y = -y;
+    }
+    return engine.a;
+}
+
+big_integer modinv(big_integer const& a, big_integer const& mod) {
+    if (mod <= 0) {
+        throw std::runtime_error("Modulus must be positive");
+    }
+    big_integer x, y;
+    big_integer residue = a % mod;
+    if (residue < 0) {
+        residue += mod;
+    }
+    if (extended_gcd(residue, mod, x, y) != 1) {
+        throw std::runtime_error("Not invertible");
+    }
+    x %= mod;
+    return x < 0 ? x += mod : x;
+}
@@ -22,6 +22,24 @@ big_integer_gmp::big_integer_gmp(std::string const& str) {
   }
 }
 
+big_integer_gmp big_integer_gmp::factorial(unsigned long n) {
+  big_integer_gmp res;
+  mpz_fac_ui(res.mpz, n);
+  return res;
+}
+
+big_integer_gmp big_integer_gmp::binomial(unsigned long n, unsigned long k) {
+  big_integer_gmp res;
+  mpz_bin_uiui(res.mpz, n, k);
+  return res;
+}
+
+big_integer_gmp big_integer_gmp::primorial(unsigned long n) {
+  big_integer_gmp res;
+  mpz_primorial_ui(res.mpz, n);
+  return res;
+}
+
 big_integer_gmp::~big_integer_gmp() {
   mpz_clear(mpz);
 }
@@ -183,6 +201,51 @@ bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b) {
   return mpz_cmp(a.mpz, b.mpz) >= 0;
 }
 
+big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod) {
+  big_integer_gmp res;
+  mpz_powm(res.mpz, base.mpz, exp.mpz, mod.mpz);
+  return res;
+}
+
+big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b) {
+  big_integer_gmp res;
+  mpz_gcd(res.mpz, a.mpz, b.mpz);
+  return res;
+}
+
+big_integer_gmp pow(big_integer_gmp const& base, unsigned long exp) {
+  big_integer_gmp res;
+  mpz_pow_ui(res.mpz, base.mpz, exp);
+  return res;
+}
+
+big_integer_gmp iroot(big_integer_gmp const& a, unsigned long k) {
+  big_integer_gmp res;
+  mpz_root(res.mpz, a.mpz, k);
+  return res;
+}
+
+big_integer_gmp isqrt(big_integer_gmp const& a) {
+  big_integer_gmp res;
+  mpz_sqrt(res.mpz, a.mpz);
+  return res;
+}
+
+bool is_perfect_square(big_integer_gmp const& a) {
+  return mpz_perfect_square_p(a.mpz) != 0;
+}
+
+// reps = 1 leaves trial division and Baillie-PSW, as in is_probable_prime
+bool is_probable_prime(big_integer_gmp const& n) {
+  return mpz_probab_prime_p(n.mpz, 1) != 0;
+}
+
+big_integer_gmp next_prime(big_integer_gmp const& n) {
+  big_integer_gmp res;
+  mpz_nextprime(res.mpz, n.mpz);
+  return res;
+}
+
 std::string to_string(big_integer_gmp const& a) {
   char* tmp = mpz_get_str(NULL, 10, a.mpz);
   std::string res = tmp;
@@ -24,6 +24,10 @@ struct big_integer_gmp {
     return *this;
   }
 
+  static big_integer_gmp factorial(unsigned long n);
+  static big_integer_gmp binomial(unsigned long n, unsigned long k);
+  static big_integer_gmp primorial(unsigned long n);
+
   ~big_integer_gmp();
 
   big_integer_gmp& operator=(big_integer_gmp const& other);
@@ -59,6 +63,14 @@ struct big_integer_gmp {
   friend bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
   friend std::string to_string(big_integer_gmp const& a);
+  friend big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod);
+  friend big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b);
+  friend big_integer_gmp pow(big_integer_gmp const& base, unsigned long exp);
+  friend big_integer_gmp iroot(big_integer_gmp const& a, unsigned long k);
+  friend big_integer_gmp isqrt(big_integer_gmp const& a);
+  friend bool is_perfect_square(big_integer_gmp const& a);
+  friend bool is_probable_prime(big_integer_gmp const& n);
+  friend big_integer_gmp next_prime(big_integer_gmp const& n);
 
  private:
   mpz_t mpz;
@@ -84,6 +96,15 @@ bool operator>(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator<=(big_integer_gmp const& a, big_integer_gmp const& b);
 bool operator>=(big_integer_gmp const& a, big_integer_gmp const& b);
 
+big_integer_gmp powmod(big_integer_gmp const& base, big_integer_gmp const& exp, big_integer_gmp const& mod);
+big_integer_gmp gcd(big_integer_gmp const& a, big_integer_gmp const& b);
+big_integer_gmp pow(big_integer_gmp const& base, unsigned long exp);
+big_integer_gmp iroot(big_integer_gmp const& a, unsigned long k);
+big_integer_gmp isqrt(big_integer_gmp const& a);
+bool is_perfect_square(big_integer_gmp const& a);
+bool is_probable_prime(big_integer_gmp const& n);
+big_integer_gmp next_prime(big_integer_gmp const& n);
+
 std::string to_string(big_integer_gmp const& a);
 std::ostream& operator<<(std::ostream& s, big_integer_gmp const& a);
 
@@ -0,0 +1,468 @@
+#include "big_integer.h"
+#include "limb_kernels.h"
+#include "modulus_context.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+std::vector<uint32_t> primes_up_to(uint32_t n) {
+    std::vector<uint32_t> primes;
+    std::vector<bool> composite(static_cast<size_t>(n) + 1);
+    for (uint64_t i = 2; i <= n; i++) {
+        if (!composite[i]) {
+            primes.push_back(static_cast<uint32_t>(i));
+            for (uint64_t j = i * i; j <= n; j += i) {
+                composite[j] = true;
+            }
+        }
+    }
+    return primes;
+}
+
+// packs small factors into single limbs before they reach the product tree
+struct factor_list {
+    void push(uint32_t factor, uint32_t times = 1) {
+        for (uint32_t i = 0; i < times; i++) {
+            if (static_cast<uint64_t>(acc) * factor > UINT32_MAX) {
+                limbs.emplace_back(acc);
+                acc = 1;
+            }
+            acc *= factor;
+        }
+    }
+
+    big_integer multiply() {
+        limbs.emplace_back(acc);
+        acc = 1;
+        return product(limbs.data(), limbs.data() + limbs.size());
+    }
+
+private:
+    uint32_t acc = 1;
+    std::vector<big_integer> limbs;
+};
+
+// odd part of n! / ((n / 2)!)^2
+big_integer odd_swing(uint32_t n, std::vector<uint32_t> const& primes) {
+    factor_list factors;
+    for (size_t i = 1; i < primes.size() && primes[i] <= n; i++) {
+        uint32_t const p = primes[i];
+        uint32_t exponent = 0;
+        for (uint32_t q = n / p; q > 0; q /= p) {
+            exponent += q & 1u;
+        }
+        factors.push(p, exponent);
+    }
+    return factors.multiply();
+}
+
+big_integer odd_factorial(uint32_t n, std::vector<uint32_t> const& primes) {
+    if (n < 2) {
+        return 1;
+    }
+    big_integer result = odd_factorial(n / 2, primes);
+    result *= result;
+    return result *= odd_swing(n, primes);
+}
+
+// bits of the exponent scanned at once by pow
+size_t window_size(size_t bits) {
+    size_t k = 1;
+    for (size_t limit : {4, 12, 24}) {
+        k += bits > limit;
+    }
+    return k;
+}
+
+// roots of at most this many bits are taken from a floating-point estimate
+size_t const ROOT_BASECASE_BITS = 48;
+
+// marks quadratic residues modulo m
+struct square_filter {
+    explicit square_filter(uint32_t m) : modulus(m), residue(m) {
+        for (uint32_t i = 0; i < m; i++) {
+            residue[i * i % m] = true;
+        }
+    }
+
+    bool passes(uint32_t r) const {
+        return residue[r % modulus];
+    }
+
+private:
+    uint32_t modulus;
+    std::vector<bool> residue;
+};
+
+// odd primes below this bound are removed by trial division before the
+// probable prime tests and sieved out of the candidates of next_prime
+uint32_t const SIEVE_LIMIT = 1024;
+size_t const SIEVE_WINDOW = 4096;
+
+std::vector<uint32_t> const& sieve_primes() {
+    static std::vector<uint32_t> const primes(primes_up_to(SIEVE_LIMIT - 1));
+    return primes;
+}
+
+big_integer const& sieve_product() {
+    static big_integer const product = primorial(SIEVE_LIMIT - 1) / 2;
+    return product;
+}
+
+// Jacobi symbol (a / m) for odd m
+int jacobi(uint32_t a, uint32_t m) {
+    int result = 1;
+    a %= m;
+    while (a != 0) {
+        while (a % 2 == 0) {
+            a /= 2;
+            if (m % 8 == 3 || m % 8 == 5) {
+                result = -result;
+            }
+        }
+        std::swap(a, m);
+        if (a % 4 == 3 && m % 4 == 3) {
+            result = -result;
+        }
+        a %= m;
+    }
+    return m == 1 ? result : 0;
+}
+
+int popcount(uint32_t n) {
+    int bits = 0;
+    for (; n != 0; n &= n - 1) {
+        bits++;
+    }
+    return bits;
+}
+}
+
+big_integer factorial(uint32_t n) {
+    // n! = odd part * 2^(n - popcount(n))
+    return odd_factorial(n, primes_up_to(n)) <<= static_cast<int>(n - popcount(n));
+}
+
+big_integer binomial(uint32_t n, uint32_t k) {
+    if (k > n) {
+        return 0;
+    }
+    // exponent of p in n! / (k! (n - k)!) by Legendre's formula
+    factor_list factors;
+    for (uint32_t p : primes_up_to(n)) {
+        uint32_t exponent = 0;
+        for (uint64_t q = p; q <= n; q *= p) {
+            exponent += static_cast<uint32_t>(n / q - k / q - (n - k) / q);
+        }
+        factors.push(p, exponent);
+    }
+    return factors.multiply();
+}
+
+big_integer primorial(uint32_t n) {
+    factor_list factors;
+    for (uint32_t p : primes_up_to(n)) {
+        factors.push(p);
+    }
+    return factors.multiply();
+}
+
+big_integer pow(big_integer const& base, uint32_t exp) {
+    if (exp == 0 || base == 0) {
+        return exp == 0 ? 1 : 0;
+    }
+    // base = odd * 2^zeros, the power of two is applied as a shift
+    size_t zeros = 0;
+    while ((base.digits[zeros / 32] >> (zeros % 32) & 1u) == 0) {
+        zeros++;
+    }
+    big_integer odd = base;
+    odd.sign = false;
+    odd >>= static_cast<int>(zeros);
+    big_integer result = 1;
+    if (odd != 1) {
+        size_t bits = 32;
+        while ((exp >> (bits - 1) & 1u) == 0) {
+            bits--;
+        }
+        // odd powers g, g^3, ..., g^(2^k - 1) for a left-to-right sliding
+        // window of k bits; squarings go through the squaring kernel
+        size_t const k = window_size(bits);
+        std::vector<big_integer> table(static_cast<size_t>(1) << (k - 1), odd);
+        big_integer const square = odd * odd;
+        for (size_t i = 1; i < table.size(); i++) {
+            table[i] = table[i - 1] * square;
+        }
+        bool started = false;
+        for (ptrdiff_t i = bits - 1; i >= 0;) {
+            if ((exp >> i & 1u) == 0) {
+                result *= result;
+                i--;
+                continue;
+            }
+            ptrdiff_t j = std::max(i - static_cast<ptrdiff_t>(k) + 1, static_cast<ptrdiff_t>(0));
+            while ((exp >> j & 1u) == 0) {
+                j++;
+            }
+            uint32_t const value = exp >> j & ((1u << (i - j + 1)) - 1);
+            if (started) {
+                for (ptrdiff_t l = j; l <= i; l++) {
+                    result *= result;
+                }
+                result *= table[value / 2];
+            } else {
+                result = table[value / 2];
+                started = true;
+            }
+            i = j - 1;
+        }
+    }
+    result.sign = base.sign && (exp & 1u);
+    return result <<= static_cast<int>(zeros * exp);
+}
+
+big_integer iroot(big_integer const& a, uint32_t k) {
+    if (k == 0) {
+        throw std::runtime_error("Root of degree zero");
+    }
+    if (a.sign) {
+        if (k % 2 == 0) {
+            throw std::runtime_error("Even root of a negative number");
+        }
+        return -iroot(-a, k);
+    }
+    size_t const bits = a.bit_length();
+    if (k == 1 || bits <= k) {
+        return k == 1 || a == 0 ? a : 1;
+    }
+    if (bits / k <= ROOT_BASECASE_BITS) {
+        // a = m * 2^(qk) with 1 <= m < 2^k, root = m^(1/k) * 2^q
+        size_t const q = (bits - 1) / k;
+        size_t const shift = bits > 64 ? bits - 64 : 0;
+        size_t const idx = shift / 32;
+        big_integer::uint128_t const window = static_cast<big_integer::uint128_t>(a.kth_digit(idx))
+                | static_cast<big_integer::uint128_t>(a.kth_digit(idx + 1)) << 32u
+                | static_cast<big_integer::uint128_t>(a.kth_digit(idx + 2)) << 64u;
+        auto const top = static_cast<uint64_t>(window >> (shift % 32));
+        double const log_m = std::log2(static_cast<double>(top)) + (static_cast<double>(shift) - static_cast<double>(q * k));
+        auto const estimate = static_cast<uint64_t>(std::ldexp(std::exp2(log_m / k), static_cast<int>(q)));
+        uint32_t const limbs[] = {static_cast<uint32_t>(estimate), static_cast<uint32_t>(estimate >> 32u)};
+        big_integer x;
+        x.assign_magnitude(limbs, 2, false);
+        while (pow(x, k) > a) {
+            --x;
+        }
+        while (pow(x + 1, k) <= a) {
+            ++x;
+        }
+        return x;
+    }
+    // the root of the leading bits gives the leading half of the root, rounded
+    // up so that Newton's iteration descends from above and stops at the root
+    size_t const h = bits / k / 2;
+    big_integer x = iroot(a >> static_cast<int>(h * k), k) + 1;
+    x <<= static_cast<int>(h);
+    big_integer const degree = k, weight = k - 1;
+    while (true) {
+        big_integer next = (weight * x + a / pow(x, k - 1)) / degree;
+        if (next >= x) {
+            return x;
+        }
+        x = next;
+    }
+}
+
+big_integer isqrt(big_integer const& a) {
+    return iroot(a, 2);
+}
+
+bool is_perfect_square(big_integer const& a) {
+    if (a.sign) {
+        return false;
+    }
+    // a square is a quadratic residue modulo every m: 64 is read from the low
+    // limb, 63, 65 and 11 from a single remainder modulo their product
+    static square_filter const by_64(64), by_63(63), by_65(65), by_11(11);
+    if (!by_64.passes(a.digits[0])) {
+        return false;
+    }
+    uint32_t const r = mod_1(a.digits.begin(), a.size(), 63 * 65 * 11);
+    if (!by_63.passes(r) || !by_65.passes(r) || !by_11.passes(r)) {
+        return false;
+    }
+    big_integer const root = isqrt(a);
+    return root * root == a;
+}
+
+bool miller_rabin(big_integer const& n, big_integer const& base) {
+    if (n < 3 || (n & 1) == 0) {
+        return n == 2;
+    }
+    // n - 1 = d * 2^s
+    big_integer const n_minus_1 = n - 1;
+    big_integer d = n_minus_1;
+    size_t s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+    big_integer x = powmod(base, d, n);
+    if (x == 1 || x == n_minus_1) {
+        return true;
+    }
+    modulus_context const ctx(n);
+    for (size_t i = 1; i < s; i++) {
+        x = ctx.mulmod(x, x);
+        if (x == n_minus_1) {
+            return true;
+        }
+        if (x == 1) {
+            return false;
+        }
+    }
+    return false;
+}
+
+namespace detail {
+// Strong Lucas probable prime test with Selfridge's parameters: D is the first
+// of 5, -7, 9, -11, ... with (D / n) = -1, P = 1 and Q = (1 - D) / 4.
+struct lucas_test {
+    explicit lucas_test(big_integer const& n_) : n(n_), ctx(n_) {}
+
+    bool run() const {
+        if (is_perfect_square(n)) {
+            return false;
+        }
+        int d = 5;
+        while (true) {
+            uint32_t const abs_d = static_cast<uint32_t>(d < 0 ? -d : d);
+            int const symbol = jacobi_of(abs_d) * (d < 0 && n.digits[0] % 4 == 3 ? -1 : 1);
+            if (symbol == -1) {
+                break;
+            }
+            if (symbol == 0 && n != abs_d) {
+                return false;
+            }
+            d = d < 0 ? 2 - d : -d - 2;
+        }
+        big_integer const D = d, Q = (1 - d) / 4;
+
+        // n + 1 = k * 2^s
+        big_integer k = n + 1;
+        size_t s = 0;
+        while ((k.digits[0] & 1u) == 0) {
+            k >>= 1;
+            s++;
+        }
+        // U_j, V_j and Q^j for j running over the leading bits of k
+        big_integer u = 1, v = 1, qj = ctx.reduce(Q);
+        for (size_t i = k.bit_length() - 1; i-- > 0;) {
+            u = ctx.mulmod(u, v);
+            v = ctx.reduce(ctx.mulmod(v, v) - 2 * qj);
+            qj = ctx.mulmod(qj, qj);
+            if (k.digits[i / 32] >> (i % 32) & 1u) {
+                big_integer const next_u = half(u + v);
+                v = half(ctx.reduce(D * u) + v);
+                u = next_u;
+                qj = ctx.mulmod(qj, Q);
+            }
+        }
+        if (u == 0 || v == 0) {
+            return true;
+        }
+        for (size_t r = 1; r < s; r++) {
+            v = ctx.reduce(ctx.mulmod(v, v) - 2 * qj);
+            if (v == 0) {
+                return true;
+            }
+            qj = ctx.mulmod(qj, qj);
+        }
+        return false;
+    }
+
+private:
+    big_integer const& n;
+    modulus_context const ctx;
+
+    // (abs_d / n) for odd abs_d by quadratic reciprocity
+    int jacobi_of(uint32_t abs_d) const {
+        int const symbol = jacobi(mod_1(n.digits.begin(), n.size(), abs_d), abs_d);
+        return abs_d % 4 == 3 && n.digits[0] % 4 == 3 ? -symbol : symbol;
+    }
+
+    // x / 2 mod n for x in [0, 2n)
+    big_integer half(big_integer x) const {
+        if (x.digits[0] & 1u) {
+            x += n;
+        }
+        x >>= 1;
+        return x < n ? x : x - n;
+    }
+};
+}
+
+bool is_probable_prime(big_integer const& n) {
+    if (n < 2) {
+        return false;
+    }
+    if (n < SIEVE_LIMIT * SIEVE_LIMIT) {
+        uint32_t const value = n.digits[0];
+        if (value % 2 == 0) {
+            return value == 2;
+        }
+        for (uint32_t p : sieve_primes()) {
+            if (p != 2 && p * p <= value && value % p == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if ((n.digits[0] & 1u) == 0 || gcd(n % sieve_product(), sieve_product()) != 1) {
+        return false;
+    }
+    return miller_rabin(n, 2) && detail::lucas_test(n).run();
+}
+
+big_integer next_prime(big_integer const& n) {
+    big_integer base = n + 1;
+    if (base <= 2) {
+        return 2;
+    }
+    if ((base.digits[0] & 1u) == 0) {
+        ++base;
+    }
+    while (base < SIEVE_LIMIT * SIEVE_LIMIT) {
+        if (is_probable_prime(base)) {
+            return base;
+        }
+        base += 2;
+    }
+    while (true) {
+        // composite[i] marks base + 2i with a factor below SIEVE_LIMIT; the
+        // residues are taken from one remainder by the product of the primes
+        std::vector<bool> composite(SIEVE_WINDOW);
+        big_integer const residue = base % sieve_product();
+        for (uint32_t p : sieve_primes()) {
+            if (p == 2) {
+                continue;
+            }
+            uint32_t const r = mod_1(residue.digits.begin(), residue.size(), p);
+            // base + 2i = 0 (mod p) for i = -r / 2 = (p - r) * (p + 1) / 2
+            for (size_t i = static_cast<uint64_t>(p - r) * ((p + 1) / 2) % p; i < SIEVE_WINDOW; i += p) {
+                composite[i] = true;
+            }
+        }
+        for (size_t i = 0; i < SIEVE_WINDOW; i++) {
+            if (composite[i]) {
+                continue;
+            }
+            big_integer candidate = base + big_integer(static_cast<uint32_t>(2 * i));
+            if (miller_rabin(candidate, 2) && detail::lucas_test(candidate).run()) {
+                return candidate;
+            }
+        }
+        base += big_integer(static_cast<uint32_t>(2 * SIEVE_WINDOW));
+    }
+}
@@ -0,0 +1,219 @@
+#include "big_integer.h"
+#include "limb_kernels.h"
+#include "modulus_context.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// arithmetic on n-limb residues in Montgomery form x * R mod m, R = 2^(32n), m odd
+struct montgomery {
+    using digit = uint32_t;
+
+    montgomery(uint32_t const* modulus, size_t length)
+            : n(length), m(modulus, modulus + length), m_inv(inverse_limb(modulus[0])), scratch(2 * length) {}
+
+    // log2 R
+    size_t r_bits() const {
+        return 32 * n;
+    }
+
+    // r = a * b / R mod m, r may alias a or b
+    void mul(uint32_t* r, uint32_t const* a, uint32_t const* b) {
+        ::mul(scratch.data(), a, n, b, n);
+        redc(r, scratch.data(), m.data(), n, m_inv);
+    }
+
+    // r = a / R mod m, takes a out of Montgomery form
+    void from(uint32_t* r, uint32_t const* a) {
+        std::copy_n(a, n, scratch.begin());
+        std::fill(scratch.begin() + n, scratch.end(), 0);
+        redc(r, scratch.data(), m.data(), n, m_inv);
+    }
+
+    // residue from / to n limbs
+    void load(uint32_t* r, uint32_t const* a) const {
+        std::copy_n(a, n, r);
+    }
+
+    void store(uint32_t* r, uint32_t const* a) const {
+        std::copy_n(a, n, r);
+    }
+
+    size_t const n;
+    std::vector<uint32_t> const m;
+    uint32_t const m_inv;
+    std::vector<uint32_t> scratch;
+};
+
+#if defined(__x86_64__)
+// The same on residues of n 52-bit digits, R = 2^(52n), multiplied with
+// AVX-512 IFMA
+struct montgomery52 {
+    using digit = uint64_t;
+
+    montgomery52(uint32_t const* modulus, size_t length)
+            : limbs(length), n(digits52(length)), m(n), scratch(2 * n + 16), one(n) {
+        to_radix52(m.data(), n, modulus, length);
+        m_inv = inverse_digit52(m[0]);
+        one[0] = 1;
+    }
+
+    size_t r_bits() const {
+        return 52 * n;
+    }
+
+    void mul(uint64_t* r, uint64_t const* a, uint64_t const* b) {
+        mont_mul_ifma(r, a, b, m.data(), n, m_inv, scratch.data());
+    }
+
+    void from(uint64_t* r, uint64_t const* a) {
+        mul(r, a, one.data());
+    }
+
+    void load(uint64_t* r, uint32_t const* a) const {
+        to_radix52(r, n, a, limbs);
+    }
+
+    void store(uint32_t* r, uint64_t const* a) const {
+        from_radix52(r, limbs, a, n);
+    }
+
+    size_t const limbs;
+    size_t const n;
+    std::vector<uint64_t> m;
+    uint64_t m_inv;
+    std::vector<uint64_t> scratch;
+    std::vector<uint64_t> one;
+};
+
+size_t const MONTGOMERY52_MIN_LIMBS = 6;
+
+bool use_montgomery52(size_t limbs) {
+    return active_kernels->variant == kernel_variant::avx512ifma && limbs >= MONTGOMERY52_MIN_LIMBS
+            && digits52(limbs) <= IFMA_MAX_DIGITS;
+}
+#endif
+
+size_t window_size(size_t bits) {
+    size_t k = 1;
+    for (size_t limit : {24, 80, 240, 672}) {
+        k += bits > limit;
+    }
+    return k;
+}
+
+// g^e mod m from the limbs of g * R mod m in the form of ctx, where bit(i)
+// is bit i of e and e has bits > 0 bits; the result is in limbs again
+template <typename Context, typename Bit>
+std::vector<uint32_t> sliding_window_pow(Context& ctx, std::vector<uint32_t> const& base, Bit const& bit, size_t bits) {
+    using digit = typename Context::digit;
+    size_t const n = ctx.n;
+
+    // odd powers g, g^3, ..., g^(2^k - 1) for a sliding window of k bits
+    size_t const k = window_size(bits);
+    std::vector<digit> table(n << (k - 1));
+    ctx.load(table.data(), base.data());
+    std::vector<digit> square(n), acc(n);
+    ctx.mul(square.data(), table.data(), table.data());
+    for (size_t i = 1; i < (static_cast<size_t>(1) << (k - 1)); i++) {
+        ctx.mul(table.data() + i * n, table.data() + (i - 1) * n, square.data());
+    }
+
+    bool started = false;
+    for (ptrdiff_t i = bits - 1; i >= 0;) {
+        if (!bit(i)) {
+            ctx.mul(acc.data(), acc.data(), acc.data());
+            i--;
+            continue;
+        }
+        ptrdiff_t j = std::max(i - static_cast<ptrdiff_t>(k) + 1, static_cast<ptrdiff_t>(0));
+        while (!bit(j)) {
+            j++;
+        }
+        size_t value = 0;
+        for (ptrdiff_t l = i; l >= j; l--) {
+            value = 2 * value + bit(l);
+        }
+        digit const* power = table.data() + (value / 2) * n;
+        if (started) {
+            for (ptrdiff_t l = j; l <= i; l++) {
+                ctx.mul(acc.data(), acc.data(), acc.data());
+            }
+            ctx.mul(acc.data(), acc.data(), power);
+        } else {
+            std::copy_n(power, n, acc.begin());
+            started = true;
+        }
+        i = j - 1;
+    }
+    ctx.from(acc.data(), acc.data());
+    std::vector<uint32_t> result(base.size());
+    ctx.store(result.data(), acc.data());
+    return result;
+}
+}
+
+big_integer powmod(big_integer base, big_integer const& exp, big_integer const& mod) {
+    if (mod <= 0) {
+        throw std::runtime_error("Modulus must be positive");
+    }
+    if (exp.sign) {
+        throw std::runtime_error("Negative exponent");
+    }
+    base %= mod;
+    if (base.sign) {
+        base += mod;
+    }
+    if (exp == 0 || mod == 1) {
+        return mod == 1 ? 0 : 1;
+    }
+
+    auto bit = [&exp](size_t i) {
+        return (exp.digits[i / 32] >> (i % 32)) & 1u;
+    };
+    size_t bits = 32 * exp.size();
+    while (!bit(bits - 1)) {
+        bits--;
+    }
+
+    if ((mod.digits[0] & 1u) == 0) {
+        // Montgomery form needs an odd modulus
+        modulus_context ctx(mod);
+        big_integer result = 1;
+        for (size_t i = 0; i < bits; i++) {
+            if (bit(i)) {
+                result = ctx.mulmod(result, base);
+            }
+            if (i + 1 < bits) {
+                base = ctx.mulmod(base, base);
+            }
+        }
+        return result;
+    }
+
+    size_t const n = mod.size();
+    // limbs of base * R mod m
+    auto to_montgomery = [&](size_t r_bits) {
+        big_integer x = base << static_cast<int>(r_bits);
+        x %= mod;
+        std::vector<uint32_t> limbs(n);
+        std::copy(x.digits.begin(), x.digits.end(), limbs.begin());
+        return limbs;
+    };
+    std::vector<uint32_t> limbs;
+#if defined(__x86_64__)
+    if (use_montgomery52(n)) {
+        montgomery52 ctx(mod.digits.begin(), n);
+        limbs = sliding_window_pow(ctx, to_montgomery(ctx.r_bits()), bit, bits);
+    } else
+#endif
+    {
+        montgomery ctx(mod.digits.begin(), n);
+        limbs = sliding_window_pow(ctx, to_montgomery(ctx.r_bits()), bit, bits);
+    }
+
+    big_integer result;
+    result.assign_magnitude(limbs.data(), n, false);
+    return result;
+}
\ No newline at end of file
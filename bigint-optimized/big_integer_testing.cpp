@@ -1,6 +1,9 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
+#include <functional>
+#include <iostream>
 #include <random>
 #include <vector>
 #include <utility>
@@ -8,6 +11,8 @@
 
 #include "big_integer.h"
 #include "big_integer_gmp.h"
+#include "limb_kernels.h"
+#include "modulus_context.h"
 
 TEST(correctness, two_plus_two) {
   EXPECT_EQ(big_integer(4), big_integer(2) + big_integer(2));
@@ -382,6 +387,14 @@ TEST(correctness, not_) {
   EXPECT_TRUE(~a == (-a - 1));
 }
 
+TEST(correctness, not_full_limbs) {
+  big_integer a("340282366920938463463374607431768211455");
+  EXPECT_EQ(big_integer("-340282366920938463463374607431768211456"), ~a);
+  EXPECT_EQ(a, ~~a);
+  EXPECT_EQ(big_integer(-1), ~big_integer(0));
+  EXPECT_EQ(big_integer(0), ~big_integer(-1));
+}
+
 TEST(correctness, shl_) {
   big_integer a = 23;
 
@@ -437,6 +450,15 @@ TEST(correctness, add_long) {
   EXPECT_EQ(c, a + b);
 }
 
+TEST(correctness, add_long_to_short) {
+  big_integer a = 5;
+  big_integer b("100000000000000000000000000000000000000");
+  big_integer c("100000000000000000000000000000000000005");
+
+  EXPECT_EQ(c, a + b);
+  EXPECT_EQ(c, b + a);
+}
+
 TEST(correctness, add_long_signed) {
   big_integer a("-1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
   big_integer b("1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
@@ -665,6 +687,18 @@ TEST(correctness, mul_merge_randomized) {
   }
 }
 
+TEST(correctness, product_tree) {
+  std::vector<big_integer> x;
+  for (size_t i = 0; i != number_of_multipliers; ++i)
+    x.emplace_back(myrand());
+  big_integer expected = merge_all(x);
+
+  EXPECT_EQ(expected, product(x.data(), x.data() + x.size()));
+  EXPECT_EQ(expected, product(x.data(), x.data() + x.size(), 4));
+  EXPECT_EQ(x[0], product(x.data(), x.data() + 1));
+  EXPECT_EQ(1, product(x.data(), x.data()));
+}
+
 namespace {
 big_integer rand_big(size_t size) {
   big_integer result = rand();
@@ -744,6 +778,18 @@ TEST(correctness_random, mul) {
   }
 }
 
+TEST(correctness_random, mul_karatsuba) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(4 * max_size, rng);
+    b.random(itn % 2 ? 4 * max_size : max_size, rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
 TEST(correctness_random, div) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -809,6 +855,14 @@ TEST(correctness_random, bit_shifts) {
   }
 }
 
+TEST(correctness, bitwise_normalized) {
+  big_integer a("18446744073709551616"); // 1 << 64
+
+  EXPECT_EQ(0, a & 1);
+  EXPECT_EQ(0, (a | 1) & 2);
+  EXPECT_EQ(0, a ^ a);
+}
+
 // TODO: extend due to idea
 TEST(correctness_twos_complement, simple) {
   std::string a = "-36893488147419103232"; // -(1 << 65)
@@ -835,3 +889,899 @@ TEST(correctness_twos_complement, all_ones) {
 
   EXPECT_EQ(to_string(gmp_ans), to_string(your_ans));
 }
+
+TEST(correctness_random, batch) {
+  std::default_random_engine rng(42);
+  size_t const count = 101;
+  std::vector<big_integer> a, b;
+  for (size_t i = 0; i != count; ++i) {
+    a.push_back(rand_big(rng() % 40) * (rng() % 2 ? 1 : -1));
+    b.push_back(i % 3 == 0 ? big_integer(myrand()) : rand_big(rng() % 20) * (rng() % 2 ? 1 : -1));
+  }
+  a.push_back(0);
+  b.push_back(-5);
+  a.push_back(-7);
+  b.push_back(7);
+
+  for (size_t threads : {1, 4}) {
+    std::vector<big_integer> sum(a.size()), product(a.size()), residue(a.size());
+    batch_add(a.data(), b.data(), sum.data(), a.size(), threads);
+    batch_mul(a.data(), b.data(), product.data(), a.size(), threads);
+    batch_mod(a.data(), b.data(), residue.data(), a.size(), threads);
+    for (size_t i = 0; i != a.size(); ++i) {
+      EXPECT_EQ(a[i] + b[i], sum[i]);
+      EXPECT_EQ(a[i] * b[i], product[i]);
+      EXPECT_EQ(a[i] % b[i], residue[i]);
+    }
+  }
+
+  std::vector<big_integer> in_place(a);
+  batch_add(in_place.data(), b.data(), in_place.data(), a.size());
+  for (size_t i = 0; i != a.size(); ++i) {
+    EXPECT_EQ(a[i] + b[i], in_place[i]);
+  }
+}
+
+TEST(correctness_random, batch_mod_limbs) {
+  std::default_random_engine rng(42);
+  std::vector<big_integer> a, b;
+  for (size_t i = 0; i != 300; ++i) {
+    big_integer d = rand_big(rng() % 12 + 1) + 1;
+    if (i % 3 == 0) {
+      // top limb with its high bit set needs no normalizing shift
+      d |= big_integer(1) << static_cast<int>(32 * (rng() % 4 + 2) - 1);
+    }
+    big_integer q = rand_big(rng() % 12);
+    a.push_back((i % 4 == 0 ? q * d - 1 : q * d + rand_big(rng() % 12)) * (rng() % 2 ? 1 : -1));
+    b.push_back(d * (rng() % 2 ? 1 : -1));
+  }
+  a.push_back(big_integer("18446744073709551615"));
+  b.push_back(big_integer("4294967297"));
+  std::vector<big_integer> residue(a.size());
+  batch_mod(a.data(), b.data(), residue.data(), a.size());
+  for (size_t i = 0; i != a.size(); ++i) {
+    EXPECT_EQ(a[i] % b[i], residue[i]);
+  }
+}
+
+TEST(correctness_random, batch_mul_karatsuba) {
+  std::default_random_engine rng(42);
+  std::vector<big_integer> a, b;
+  for (size_t i = 0; i != 8; ++i) {
+    size_t const n = KARATSUBA_THRESHOLD + rng() % 400;
+    a.push_back(rand_big(n) * (rng() % 2 ? 1 : -1));
+    b.push_back(rand_big(i % 2 ? n : KARATSUBA_THRESHOLD + rng() % 20));
+  }
+  for (size_t threads : {1, 4}) {
+    std::vector<big_integer> product(a.size());
+    batch_mul(a.data(), b.data(), product.data(), a.size(), threads);
+    for (size_t i = 0; i != a.size(); ++i) {
+      EXPECT_EQ(a[i] * b[i], product[i]);
+    }
+  }
+}
+
+TEST(correctness, factorial) {
+  EXPECT_EQ(1, factorial(0));
+  EXPECT_EQ(1, factorial(1));
+  EXPECT_EQ(3628800, factorial(10));
+  EXPECT_EQ(big_integer("2432902008176640000"), factorial(20));
+  for (unsigned n : {13, 100, 257, 1000, 2048}) {
+    EXPECT_EQ(to_string(big_integer_gmp::factorial(n)), to_string(factorial(n)));
+  }
+}
+
+TEST(correctness, binomial) {
+  EXPECT_EQ(0, binomial(3, 4));
+  EXPECT_EQ(1, binomial(0, 0));
+  EXPECT_EQ(252, binomial(10, 5));
+  for (unsigned n : {64, 500, 1500}) {
+    for (unsigned k : {1u, 7u, n / 3, n / 2, n}) {
+      EXPECT_EQ(to_string(big_integer_gmp::binomial(n, k)), to_string(binomial(n, k)));
+    }
+  }
+}
+
+TEST(correctness, primorial) {
+  EXPECT_EQ(1, primorial(1));
+  EXPECT_EQ(30, primorial(6));
+  for (unsigned n : {100, 1000, 5000}) {
+    EXPECT_EQ(to_string(big_integer_gmp::primorial(n)), to_string(primorial(n)));
+  }
+}
+
+// The performance tests print timing tables and are disabled by default; run
+// them with --gtest_also_run_disabled_tests --gtest_filter='performance.*'
+namespace {
+template<typename F>
+double measure_ms(F const& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+TEST(performance, DISABLED_factorial) {
+  unsigned const n = 20000;
+  big_integer naive = 1, fast;
+  big_integer_gmp gmp;
+  double naive_ms = measure_ms([&] {
+    for (unsigned i = 2; i <= n; ++i)
+      naive *= i;
+  });
+  double fast_ms = measure_ms([&] { fast = factorial(n); });
+  double gmp_ms = measure_ms([&] { gmp = big_integer_gmp::factorial(n); });
+  std::cout << n << "!: naive " << naive_ms << " ms, prime swing " << fast_ms
+            << " ms, mpz_fac_ui " << gmp_ms << " ms" << std::endl;
+  EXPECT_EQ(naive, fast);
+}
+
+TEST(correctness, powmod) {
+  EXPECT_EQ(1, powmod(big_integer(5), 0, 7));
+  EXPECT_EQ(0, powmod(big_integer(5), 3, 1));
+  EXPECT_EQ(4, powmod(big_integer(2), 10, 1020));
+  EXPECT_EQ(6, powmod(big_integer(-1), 1, 7));
+  EXPECT_EQ(445, powmod(big_integer(4), 13, 497));
+}
+
+TEST(correctness_random, powmod) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp base, exp, mod;
+    base.random(max_size, rng);
+    exp.random(max_size / 4, rng);
+    mod.random(max_size / (itn + 1), rng);
+    if (exp < 0)
+      exp = -exp;
+    if (mod <= 0)
+      mod = -mod + 1;
+    big_integer_gmp c = powmod(base, exp, mod);
+    big_integer R = powmod(big_integer(to_string(base)), big_integer(to_string(exp)), big_integer(to_string(mod)));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(performance, DISABLED_powmod) {
+  std::default_random_engine rng(42);
+  big_integer_gmp base, exp, mod;
+  base.random(1024, rng);
+  exp.random(1024, rng);
+  mod.random(1024, rng);
+  if (exp < 0)
+    exp = -exp;
+  if (mod < 0)
+    mod = -mod;
+  mod |= 1;
+  big_integer_gmp gmp;
+  big_integer b(to_string(base)), e(to_string(exp)), m(to_string(mod)), naive = 1, fast;
+  double naive_ms = measure_ms([&] {
+    big_integer power = b % m;
+    for (big_integer rest = e; rest != 0; rest >>= 1) {
+      if ((rest & 1) != 0)
+        naive = naive * power % m;
+      power = power * power % m;
+    }
+    if (naive < 0)
+      naive += m;
+  });
+  double fast_ms = measure_ms([&] { fast = powmod(b, e, m); });
+  double gmp_ms = measure_ms([&] { gmp = powmod(base, exp, mod); });
+  std::cout << "1024-bit powmod: multiply and %= " << naive_ms << " ms, montgomery " << fast_ms
+            << " ms, mpz_powm " << gmp_ms << " ms" << std::endl;
+  EXPECT_EQ(naive, fast);
+  EXPECT_EQ(to_string(gmp), to_string(fast));
+}
+
+TEST(correctness_random, modulus_context) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp mod, a, b;
+    mod.random(max_size / 2 - itn * 97, rng);
+    if (mod <= 0)
+      mod = -mod + 1;
+    a.random(max_size - itn * 97 + (itn % 3 ? 0 : 200), rng);
+    b.random(max_size / 2, rng);
+    modulus_context ctx(big_integer(to_string(mod)));
+    big_integer A(to_string(a)), B(to_string(b));
+
+    big_integer_gmp expected = a % mod;
+    if (expected < 0)
+      expected += mod;
+    EXPECT_EQ(to_string(expected), to_string(ctx.reduce(A)));
+
+    expected = a * b % mod;
+    if (expected < 0)
+      expected += mod;
+    EXPECT_EQ(to_string(expected), to_string(ctx.mulmod(A, B)));
+
+    expected = (a + b) % mod;
+    if (expected < 0)
+      expected += mod;
+    EXPECT_EQ(to_string(expected), to_string(ctx.addmod(A, B)));
+  }
+}
+
+TEST(performance, DISABLED_modulus_context) {
+  std::default_random_engine rng(42);
+  big_integer_gmp mod;
+  mod.random(1024, rng);
+  big_integer m(to_string(mod < 0 ? -mod : mod));
+  std::vector<big_integer> values;
+  for (size_t i = 0; i != number_of_multipliers; ++i) {
+    big_integer_gmp a;
+    a.random(2000, rng);
+    values.emplace_back(to_string(a < 0 ? -a : a));
+  }
+  std::vector<big_integer> slow(values.size()), fast(values.size());
+  double slow_ms = measure_ms([&] {
+    for (size_t i = 0; i != values.size(); ++i)
+      slow[i] = values[i] % m;
+  });
+  modulus_context ctx(m);
+  double fast_ms = measure_ms([&] {
+    for (size_t i = 0; i != values.size(); ++i)
+      fast[i] = ctx.reduce(values[i]);
+  });
+  std::cout << values.size() << " reductions by a 1024-bit modulus: %= " << slow_ms << " ms, barrett "
+            << fast_ms << " ms" << std::endl;
+  EXPECT_EQ(slow, fast);
+}
+
+TEST(correctness, gcd) {
+  EXPECT_EQ(0, gcd(big_integer(0), 0));
+  EXPECT_EQ(5, gcd(big_integer(0), -5));
+  EXPECT_EQ(6, gcd(big_integer(-12), 18));
+  EXPECT_EQ(36, lcm(-12, 18));
+  EXPECT_EQ(0, lcm(0, 18));
+  EXPECT_EQ(4, modinv(3, 11));
+  EXPECT_EQ(7, modinv(-3, 11));
+  EXPECT_THROW(modinv(6, 9), std::runtime_error);
+
+  big_integer x, y;
+  EXPECT_EQ(2, extended_gcd(240, -46, x, y));
+  EXPECT_EQ(2, 240 * x - 46 * y);
+}
+
+TEST(correctness_random, gcd) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b, g;
+    a.random(max_size, rng);
+    b.random(max_size / (itn % 3 + 1), rng);
+    g.random(max_size / 8, rng);
+    a *= g;
+    b *= g;
+    big_integer A(to_string(a)), B(to_string(b));
+    EXPECT_EQ(to_string(gcd(a, b)), to_string(gcd(A, B)));
+
+    big_integer x, y;
+    big_integer G = extended_gcd(A, B, x, y);
+    EXPECT_EQ(G, A * x + B * y);
+  }
+}
+
+TEST(correctness_random, gcd_huge) {
+  for (size_t size : {300, 700, 1500}) {
+    big_integer g = rand_big(size / 4);
+    big_integer a = rand_big(size) * g, b = rand_big(size - size / 3) * g;
+    big_integer x, y;
+    big_integer G = extended_gcd(a, b, x, y);
+    EXPECT_EQ(G, gcd(a, b));
+    EXPECT_EQ(G, a * x + b * y);
+    EXPECT_EQ(0, a % G);
+    EXPECT_EQ(0, b % G);
+    EXPECT_EQ(0, G % g);
+  }
+}
+
+TEST(performance, DISABLED_gcd) {
+  big_integer a = rand_big(1000), b = rand_big(1000);
+  big_integer_gmp ga(to_string(a)), gb(to_string(b)), gmp;
+  big_integer naive, fast;
+  double naive_ms = measure_ms([&] {
+    big_integer x = a, y = b;
+    while (y != 0) {
+      x %= y;
+      std::swap(x, y);
+    }
+    naive = x;
+  });
+  double fast_ms = measure_ms([&] { fast = gcd(a, b); });
+  double gmp_ms = measure_ms([&] { gmp = gcd(ga, gb); });
+  std::cout << "31000-bit gcd: euclid with %= " << naive_ms << " ms, lehmer/half-gcd " << fast_ms
+            << " ms, mpz_gcd " << gmp_ms << " ms" << std::endl;
+  EXPECT_EQ(naive, fast);
+  EXPECT_EQ(to_string(gmp), to_string(fast));
+}
+
+TEST(correctness, isqrt) {
+  EXPECT_EQ(0, isqrt(big_integer(0)));
+  EXPECT_EQ(1, isqrt(big_integer(3)));
+  EXPECT_EQ(2, isqrt(big_integer(4)));
+  EXPECT_EQ(big_integer("99999999999999999999"), isqrt(big_integer("9999999999999999999800000000000000000001")));
+  EXPECT_EQ(big_integer("99999999999999999998"), isqrt(big_integer("9999999999999999999800000000000000000000")));
+  EXPECT_EQ(-3, iroot(big_integer(-27), 3));
+  EXPECT_EQ(1, iroot(big_integer(1000), 10));
+  EXPECT_EQ(2, iroot(big_integer(1) << 100, 100));
+  EXPECT_THROW(isqrt(big_integer(-4)), std::runtime_error);
+  EXPECT_THROW(iroot(big_integer(8), 0), std::runtime_error);
+
+  EXPECT_TRUE(is_perfect_square(big_integer(0)));
+  EXPECT_TRUE(is_perfect_square(big_integer(1) << 64));
+  EXPECT_FALSE(is_perfect_square(big_integer(-4)));
+  EXPECT_FALSE(is_perfect_square((big_integer(1) << 64) + 1));
+}
+
+TEST(correctness_random, isqrt) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * 8, rng);
+    if (a < 0) {
+      a = -a;
+    }
+    unsigned long k = rng() % 9 + 2;
+    big_integer A(to_string(a));
+    EXPECT_EQ(to_string(isqrt(a)), to_string(isqrt(A)));
+    EXPECT_EQ(to_string(iroot(a, k)), to_string(iroot(A, static_cast<uint32_t>(k))));
+
+    big_integer_gmp r = isqrt(a);
+    EXPECT_TRUE(is_perfect_square(big_integer(to_string(r * r))));
+    EXPECT_EQ(is_perfect_square(r * r + 1), is_perfect_square(big_integer(to_string(r * r + 1))));
+  }
+}
+
+TEST(performance, DISABLED_isqrt) {
+  big_integer a = rand_big(300);
+  big_integer_gmp ga(to_string(a)), gmp;
+  big_integer naive, fast;
+  double naive_ms = measure_ms([&] {
+    big_integer lo = 0, hi = big_integer(1) << static_cast<int>(32 * 150 + 1);
+    while (hi - lo > 1) {
+      big_integer mid = (lo + hi) >> 1;
+      (mid * mid <= a ? lo : hi) = mid;
+    }
+    naive = lo;
+  });
+  double fast_ms = measure_ms([&] { fast = isqrt(a); });
+  double gmp_ms = measure_ms([&] { gmp = isqrt(ga); });
+  std::cout << "9300-bit isqrt: bisection " << naive_ms << " ms, newton " << fast_ms << " ms, mpz_sqrt " << gmp_ms
+            << " ms" << std::endl;
+  EXPECT_EQ(naive, fast);
+  EXPECT_EQ(to_string(gmp), to_string(fast));
+
+  big_integer b = rand_big(2000);
+  big_integer_gmp gb(to_string(b));
+  fast_ms = measure_ms([&] { fast = iroot(b, 3); });
+  gmp_ms = measure_ms([&] { gmp = iroot(gb, 3); });
+  std::cout << "62000-bit cube root: newton " << fast_ms << " ms, mpz_root " << gmp_ms << " ms" << std::endl;
+  EXPECT_EQ(to_string(gmp), to_string(fast));
+}
+
+TEST(correctness, pow) {
+  EXPECT_EQ(1, pow(big_integer(0), 0));
+  EXPECT_EQ(0, pow(big_integer(0), 5));
+  EXPECT_EQ(1, pow(big_integer(-1), 10));
+  EXPECT_EQ(-1, pow(big_integer(-1), 11));
+  EXPECT_EQ(-1000000000, pow(big_integer(-10), 9));
+  EXPECT_EQ(big_integer(1) << 100, pow(big_integer(2), 100));
+  EXPECT_EQ(big_integer("1000000000000000000000000000000"), pow(big_integer(10), 30));
+  EXPECT_EQ(big_integer("-2251799813685248"), pow(big_integer(-8), 17));
+}
+
+TEST(correctness, sqr) {
+  for (size_t size : {1, 5, 40, 63, 64, 65, 150, 400}) {
+    big_integer a = rand_big(size);
+    big_integer b = a;
+    big_integer copy(to_string(a));
+    EXPECT_EQ(a * copy, a * b);
+    a *= a;
+    EXPECT_EQ(b * copy, a);
+  }
+}
+
+TEST(correctness_random, pow) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(rng() % 200, rng);
+    a <<= static_cast<int>(rng() % 70);
+    unsigned long exp = rng() % 300;
+    big_integer A(to_string(a));
+    EXPECT_EQ(to_string(pow(a, exp)), to_string(pow(A, static_cast<uint32_t>(exp))));
+  }
+}
+
+TEST(performance, DISABLED_pow) {
+  big_integer_gmp gmp;
+  big_integer naive = 1, fast;
+  double naive_ms = measure_ms([&] {
+    for (size_t i = 0; i < 100000; i++) {
+      naive *= 3;
+    }
+  });
+  double fast_ms = measure_ms([&] { fast = pow(big_integer(3), 100000); });
+  double gmp_ms = measure_ms([&] { gmp = pow(big_integer_gmp(3), 100000); });
+  std::cout << "3^100000: repeated *= 3 " << naive_ms << " ms, pow " << fast_ms << " ms, mpz_pow_ui " << gmp_ms
+            << " ms" << std::endl;
+  EXPECT_EQ(naive, fast);
+  EXPECT_EQ(to_string(gmp % 1000000007), to_string(fast % 1000000007));
+
+  fast_ms = measure_ms([&] { fast = pow(big_integer(3), 1000000); });
+  gmp_ms = measure_ms([&] { gmp = pow(big_integer_gmp(3), 1000000); });
+  std::cout << "3^1000000: pow " << fast_ms << " ms, mpz_pow_ui " << gmp_ms << " ms" << std::endl;
+  EXPECT_EQ(powmod(big_integer(3), 1000000, 1000000007), fast % 1000000007);
+  EXPECT_EQ(to_string(gmp % 1000000007), to_string(fast % 1000000007));
+}
+
+TEST(correctness, primality) {
+  std::vector<bool> composite(10000);
+  for (int i = 2; i < 10000; i++) {
+    EXPECT_EQ(!composite[i], is_probable_prime(big_integer(i)));
+    for (int j = 2 * i; j < 10000; j += i) {
+      composite[j] = true;
+    }
+  }
+  // strong pseudoprimes to base 2 and Carmichael numbers
+  for (int n : {2047, 3277, 4033, 4681, 8321, 561, 41041, 825265}) {
+    EXPECT_FALSE(is_probable_prime(big_integer(n)));
+  }
+  EXPECT_TRUE(miller_rabin(big_integer(2047), 2));
+  EXPECT_FALSE(miller_rabin(big_integer(2047), 3));
+  EXPECT_FALSE(is_probable_prime(big_integer("3825123056546413051")));
+  EXPECT_FALSE(is_probable_prime(big_integer("318665857834031151167461")));
+
+  big_integer mersenne_127 = (big_integer(1) << 127) - 1;
+  big_integer mersenne_521 = (big_integer(1) << 521) - 1;
+  EXPECT_TRUE(is_probable_prime(mersenne_127));
+  EXPECT_TRUE(is_probable_prime(mersenne_521));
+  EXPECT_FALSE(is_probable_prime(mersenne_127 * mersenne_521));
+  EXPECT_FALSE(is_probable_prime((big_integer(1) << 128) + 1));
+  EXPECT_FALSE(is_probable_prime(-mersenne_127));
+
+  EXPECT_EQ(2, next_prime(big_integer(-5)));
+  EXPECT_EQ(3, next_prime(big_integer(2)));
+  EXPECT_EQ(1048583, next_prime(big_integer(1048576)));
+  EXPECT_EQ(mersenne_127, next_prime(mersenne_127 - 18));
+  EXPECT_EQ(to_string(next_prime(big_integer_gmp(to_string(mersenne_521)))), to_string(next_prime(mersenne_521)));
+}
+
+TEST(correctness_random, primality) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(64 + rng() % 500, rng);
+    if (a < 0) {
+      a = -a;
+    }
+    big_integer A(to_string(a));
+    big_integer_gmp p = next_prime(a);
+    big_integer P = next_prime(A);
+    EXPECT_EQ(to_string(p), to_string(P));
+    EXPECT_TRUE(is_probable_prime(P));
+    EXPECT_FALSE(is_probable_prime(P * next_prime(P)));
+    for (int i = 0; i < 50; i++) {
+      EXPECT_EQ(is_probable_prime(a + i), is_probable_prime(A + i));
+    }
+  }
+}
+
+TEST(performance, DISABLED_primality) {
+  std::default_random_engine rng(7);
+  for (size_t bits : {1024, 2048}) {
+    std::vector<big_integer> odd, primes;
+    std::vector<big_integer_gmp> gmp_odd, gmp_primes;
+    for (size_t i = 0; i < 100; i++) {
+      big_integer_gmp a;
+      a.random(bits - 1, rng);
+      a = (a << 1) + 1;
+      if (a < 0) {
+        a = -a;
+      }
+      gmp_odd.push_back(a);
+      odd.emplace_back(to_string(a));
+      if (i < 3) {
+        gmp_primes.push_back(next_prime(a));
+        primes.emplace_back(to_string(gmp_primes.back()));
+      }
+    }
+    size_t found = 0, gmp_found = 0;
+    double odd_ms = measure_ms([&] {
+      for (big_integer const& n : odd) {
+        found += is_probable_prime(n);
+      }
+    });
+    double gmp_odd_ms = measure_ms([&] {
+      for (big_integer_gmp const& n : gmp_odd) {
+        gmp_found += is_probable_prime(n);
+      }
+    });
+    double prime_ms = measure_ms([&] {
+      for (big_integer const& n : primes) {
+        EXPECT_TRUE(is_probable_prime(n));
+      }
+    });
+    double gmp_prime_ms = measure_ms([&] {
+      for (big_integer_gmp const& n : gmp_primes) {
+        EXPECT_TRUE(is_probable_prime(n));
+      }
+    });
+    std::cout << bits << "-bit tests per second: random odd " << 1000 * odd.size() / odd_ms << " (mpz "
+              << 1000 * gmp_odd.size() / gmp_odd_ms << "), primes " << 1000 * primes.size() / prime_ms << " (mpz "
+              << 1000 * gmp_primes.size() / gmp_prime_ms << ")" << std::endl;
+    EXPECT_EQ(gmp_found, found);
+  }
+}
+
+TEST(correctness, small_overflow) {
+  big_integer max_64 = (big_integer(1) << 64) - 1;
+  EXPECT_EQ(big_integer(1) << 64, max_64 + 1);
+  EXPECT_EQ(-(big_integer(1) << 64), -max_64 - 1);
+  EXPECT_EQ(0, max_64 - max_64);
+  EXPECT_EQ((big_integer(1) << 128) - (big_integer(1) << 65) + 1, max_64 * max_64);
+  EXPECT_EQ(-max_64 + 1, 1 - max_64);
+  EXPECT_EQ(big_integer(1) << 32, (max_64 >> 32) + 1);
+  EXPECT_EQ(-2, big_integer(-7) / 3);
+  EXPECT_EQ(-1, big_integer(-7) % 3);
+  EXPECT_EQ(1, big_integer(7) % -3);
+}
+
+TEST(correctness_random, small_values) {
+  std::default_random_engine rng(42);
+  std::uniform_int_distribution<uint64_t> dist;
+  for (size_t itn = 0; itn != 100 * number_of_iterations; ++itn) {
+    uint64_t values[2];
+    for (uint64_t& value : values) {
+      value = dist(rng) >> (rng() % 64);
+      if (rng() % 8 == 0) {
+        value = UINT64_MAX - value % 3;
+      }
+    }
+    std::string a_str = (rng() % 2 ? "-" : "") + std::to_string(values[0]);
+    std::string b_str = (rng() % 2 ? "-" : "") + std::to_string(values[1] + (values[1] == 0));
+    big_integer a(a_str), b(b_str);
+    big_integer_gmp ga(a_str), gb(b_str);
+    EXPECT_EQ(to_string(ga + gb), to_string(a + b));
+    EXPECT_EQ(to_string(ga - gb), to_string(a - b));
+    EXPECT_EQ(to_string(ga * gb), to_string(a * b));
+    EXPECT_EQ(to_string(ga / gb), to_string(a / b));
+    EXPECT_EQ(to_string(ga % gb), to_string(a % b));
+  }
+}
+
+TEST(performance, DISABLED_small_values) {
+  std::default_random_engine rng(7);
+  std::vector<big_integer> values;
+  std::vector<big_integer_gmp> gmp_values;
+  for (size_t i = 0; i < 1000; i++) {
+    std::string str = std::to_string(rng() % 1000000 + 1);
+    values.emplace_back(str);
+    gmp_values.emplace_back(str);
+  }
+  big_integer sum, product = 1;
+  big_integer_gmp gmp_sum, gmp_product = 1;
+  double fast_ms = measure_ms([&] {
+    for (size_t round = 0; round < 1000; round++) {
+      for (big_integer const& v : values) {
+        sum += v;
+        product *= v;
+        product %= 1000000007;
+      }
+    }
+  });
+  double gmp_ms = measure_ms([&] {
+    for (size_t round = 0; round < 1000; round++) {
+      for (big_integer_gmp const& v : gmp_values) {
+        gmp_sum += v;
+        gmp_product *= v;
+        gmp_product %= 1000000007;
+      }
+    }
+  });
+  std::cout << "1000000 64-bit +=, *=, %=: big_integer " << fast_ms << " ms, mpz " << gmp_ms << " ms" << std::endl;
+  EXPECT_EQ(to_string(gmp_sum), to_string(sum));
+  EXPECT_EQ(to_string(gmp_product), to_string(product));
+}
+
+namespace {
+std::vector<uint32_t> rand_limbs(size_t n, std::default_random_engine& rng) {
+  std::vector<uint32_t> limbs(n);
+  for (uint32_t& limb : limbs) {
+    limb = rng() % 4 == 0 ? UINT32_MAX : static_cast<uint32_t>(rng());
+  }
+  return limbs;
+}
+
+// runs f with every variant the host supports and compares the results with
+// those of the generic one
+template <typename F>
+void compare_kernels(F const& f) {
+  kernel_variant const saved = active_kernels->variant;
+  force_kernels(kernel_variant::generic);
+  auto expected = f();
+  for (kernel_variant variant : KERNEL_VARIANTS) {
+    if (force_kernels(variant)) {
+      EXPECT_EQ(expected, f()) << kernels_of(variant).name;
+    }
+  }
+  force_kernels(saved);
+}
+}
+
+TEST(correctness, kernel_dispatch) {
+  cpu_features const& features = host_cpu_features();
+  EXPECT_EQ(features.bmi2 && features.adx, kernels_supported(kernel_variant::bmi2_adx));
+  EXPECT_TRUE(kernels_supported(kernel_variant::generic));
+  kernel_variant const saved = active_kernels->variant;
+  for (kernel_variant variant : KERNEL_VARIANTS) {
+    EXPECT_EQ(variant, kernels_of(variant).variant);
+    bool const supported = kernels_supported(variant);
+    EXPECT_EQ(supported, force_kernels(variant));
+    if (supported) {
+      EXPECT_EQ(&kernels_of(variant), active_kernels);
+    }
+    big_integer a = rand_big(100), b = rand_big(60);
+    EXPECT_EQ(a * a - a, (a - 1) * a);
+    EXPECT_EQ(a, a * b / b);
+  }
+  force_kernels(saved);
+}
+
+TEST(correctness_random, kernel_variants) {
+  std::default_random_engine rng(42);
+  for (size_t n = 1; n < 70; n++) {
+    std::vector<uint32_t> a = rand_limbs(n, rng), b = rand_limbs(n, rng), c = rand_limbs(n, rng);
+    uint32_t const v = static_cast<uint32_t>(rng());
+    unsigned const shift = rng() % 31 + 1;
+    using result = std::pair<uint32_t, std::vector<uint32_t>>;
+    compare_kernels([&] {
+      std::vector<uint32_t> r(n);
+      return result(add_n(r.data(), a.data(), b.data(), n), r);
+    });
+    compare_kernels([&] {
+      std::vector<uint32_t> r(n);
+      return result(add_n(r.data(), a.data(), b.data(), n, 1), r);
+    });
+    compare_kernels([&] {
+      std::vector<uint32_t> r(n);
+      return result(sub_n(r.data(), a.data(), b.data(), n), r);
+    });
+    compare_kernels([&] {
+      std::vector<uint32_t> r(n);
+      return result(mul_1(r.data(), a.data(), n, v), r);
+    });
+    compare_kernels([&] {
+      std::vector<uint32_t> r = c;
+      return result(addmul_1(r.data(), a.data(), n, v), r);
+    });
+    compare_kernels([&] {
+      std::vector<uint32_t> r = c;
+      return result(submul_1(r.data(), a.data(), n, v), r);
+    });
+    compare_kernels([&] {
+      std::vector<uint32_t> r(n);
+      return result(lshift(r.data(), a.data(), n, shift), r);
+    });
+    compare_kernels([&] {
+      std::vector<uint32_t> r = a;
+      return result(rshift(r.data(), r.data(), n, shift), r);
+    });
+    for (size_t m : {1, 2, 3, 8, 9}) {
+      std::vector<uint32_t> d = rand_limbs(m, rng);
+      compare_kernels([&] {
+        std::vector<uint32_t> r(n + m);
+        mul_basecase(r.data(), a.data(), n, d.data(), m);
+        return r;
+      });
+    }
+  }
+}
+
+TEST(correctness_random, logic_kernels) {
+  std::default_random_engine rng(42);
+  for (size_t offset = 0; offset < 4; offset++) {
+    for (size_t n = 1; n < 100; n++) {
+      std::vector<uint32_t> a = rand_limbs(n + offset, rng), b = rand_limbs(n + 1, rng);
+      uint32_t const* x = a.data() + offset;
+      uint32_t const* y = b.data() + 1;
+      // differs from x in one random limb, or not at all
+      std::vector<uint32_t> z(x, x + n);
+      if (rng() % 4 != 0) {
+        z[rng() % n] ^= 1u << rng() % 32;
+      }
+      compare_kernels([&] {
+        std::vector<uint32_t> r(n + 3);
+        and_n(r.data() + 3 - offset % 3, x, y, n);
+        return r;
+      });
+      compare_kernels([&] {
+        std::vector<uint32_t> r(n + 3);
+        ior_n(r.data() + offset % 3, x, y, n);
+        return r;
+      });
+      compare_kernels([&] {
+        std::vector<uint32_t> r(n + 3);
+        xor_n(r.data() + 1, x, y, n);
+        return r;
+      });
+      compare_kernels([&] {
+        std::vector<uint32_t> r(x, x + n);
+        com_n(r.data(), r.data(), n);
+        return r;
+      });
+      compare_kernels([&] {
+        return std::make_pair(equal_n(x, z.data(), n), cmp_n(x, z.data(), n));
+      });
+      compare_kernels([&] {
+        return std::make_pair(equal_n(x, y, n), cmp_n(y, x, n));
+      });
+      EXPECT_EQ(std::equal(z.begin(), z.end(), x), equal_n(x, z.data(), n));
+    }
+  }
+  big_integer x = rand_big(200), y = -rand_big(150);
+  compare_kernels([&] { return to_string(x & y); });
+  compare_kernels([&] { return std::make_pair(x == big_integer(to_string(x)), x == x + 1); });
+}
+
+TEST(performance, DISABLED_logic_kernels) {
+  size_t const n = 1000;
+  std::default_random_engine rng(42);
+  std::vector<uint32_t> a = rand_limbs(n, rng), b = a, r(n);
+  big_integer x = rand_big(2000), y = -rand_big(2000), z, w = x & y;
+  kernel_variant const saved = active_kernels->variant;
+  std::cout << "1000-limb kernels x 10000 and 62000-bit &, == x 1000, in ms" << std::endl;
+  std::cout << "variant\tand_n\txor_n\tcom_n\tequal_n\tcmp_n\t&\t==" << std::endl;
+  for (kernel_variant variant : KERNEL_VARIANTS) {
+    if (!force_kernels(variant)) {
+      continue;
+    }
+    std::vector<double> row;
+    bool same = true;
+    auto repeat_ms = [&](int times, std::function<void()> const& f) {
+      row.push_back(measure_ms([&] {
+        for (int i = 0; i < times; i++) {
+          f();
+        }
+      }));
+    };
+    repeat_ms(10000, [&] { and_n(r.data(), a.data(), b.data(), n); });
+    repeat_ms(10000, [&] { xor_n(r.data(), a.data(), b.data(), n); });
+    repeat_ms(10000, [&] { com_n(r.data(), a.data(), n); });
+    repeat_ms(10000, [&] { same &= equal_n(a.data(), b.data(), n); });
+    repeat_ms(10000, [&] { same &= cmp_n(a.data(), b.data(), n) == 0; });
+    repeat_ms(1000, [&] { z = x & y; });
+    repeat_ms(1000, [&] { same &= z == w; });
+    EXPECT_TRUE(same);
+    std::cout << kernels_of(variant).name;
+    for (double ms : row) {
+      std::cout << '\t' << ms;
+    }
+    std::cout << std::endl;
+  }
+  force_kernels(saved);
+}
+
+TEST(correctness_random, radix52) {
+  std::default_random_engine rng(42);
+  for (size_t n = 1; n < 40; n++) {
+    std::vector<uint32_t> a = rand_limbs(n, rng), back(n);
+    std::vector<uint64_t> digits(digits52(n));
+    to_radix52(digits.data(), digits.size(), a.data(), n);
+    for (uint64_t d : digits) {
+      EXPECT_EQ(d & DIGIT52_MASK, d);
+    }
+    from_radix52(back.data(), n, digits.data(), digits.size());
+    EXPECT_EQ(a, back);
+  }
+}
+
+TEST(correctness_random, ifma_mul) {
+  kernel_variant const saved = active_kernels->variant;
+  if (!force_kernels(kernel_variant::avx512ifma)) {
+    return;
+  }
+  std::default_random_engine rng(42);
+  for (size_t bits : {700, 767, 768, 800, 1500, 4000, 9000, 25000}) {
+    big_integer_gmp a, b;
+    a.random(bits, rng);
+    b.random(bits / 3 + rng() % bits, rng);
+    big_integer x(to_string(a)), y(to_string(b));
+    EXPECT_EQ(to_string(a * b), to_string(x * y));
+    EXPECT_EQ(to_string(a * a), to_string(x * x));
+  }
+  force_kernels(saved);
+}
+
+TEST(correctness_random, ifma_powmod) {
+  kernel_variant const saved = active_kernels->variant;
+  if (!force_kernels(kernel_variant::avx512ifma)) {
+    return;
+  }
+  std::default_random_engine rng(42);
+  for (size_t bits : {150, 191, 192, 255, 520, 1023, 2048, 3500}) {
+    big_integer_gmp base, exp, mod;
+    base.random(bits + 40, rng);
+    exp.random(200, rng);
+    mod.random(bits, rng);
+    if (exp < 0)
+      exp = -exp;
+    if (mod < 0)
+      mod = -mod;
+    mod |= 1;
+    big_integer_gmp c = powmod(base, exp, mod);
+    big_integer r = powmod(big_integer(to_string(base)), big_integer(to_string(exp)), big_integer(to_string(mod)));
+    EXPECT_EQ(to_string(c), to_string(r));
+  }
+  force_kernels(saved);
+}
+
+TEST(performance, DISABLED_ifma) {
+  std::default_random_engine rng(42);
+  big_integer_gmp a, b, e, m;
+  a.random(30000, rng);
+  b.random(30000, rng);
+  e.random(2048, rng);
+  m.random(2048, rng);
+  if (e < 0)
+    e = -e;
+  if (m < 0)
+    m = -m;
+  m |= 1;
+  big_integer x(to_string(a)), y(to_string(b)), exp(to_string(e)), mod(to_string(m)), xy, p;
+  kernel_variant const saved = active_kernels->variant;
+  std::cout << "variant\t30000-bit mul x 100\t2048-bit powmod" << std::endl;
+  for (kernel_variant variant : {kernel_variant::avx512, kernel_variant::avx512ifma}) {
+    if (!force_kernels(variant)) {
+      continue;
+    }
+    double mul_ms = measure_ms([&] {
+      for (int i = 0; i < 100; i++) {
+        xy = x * y;
+      }
+    });
+    double pow_ms = measure_ms([&] { p = powmod(x, exp, mod); });
+    std::cout << kernels_of(variant).name << '\t' << mul_ms << '\t' << pow_ms << std::endl;
+    EXPECT_EQ(to_string(a * b), to_string(xy));
+    EXPECT_EQ(to_string(powmod(a, e, m)), to_string(p));
+  }
+  force_kernels(saved);
+}
+
+TEST(performance, DISABLED_kernel_variants) {
+  size_t const n = 1000;
+  std::default_random_engine rng(42);
+  std::vector<uint32_t> a = rand_limbs(n, rng), b = rand_limbs(n, rng), r(2 * n);
+  big_integer x = rand_big(2000), y = rand_big(2000), xy, q;
+  kernel_variant const saved = active_kernels->variant;
+  std::cout << "1000-limb kernels x 10000 and 62000-bit mul, div, in ms" << std::endl;
+  std::cout << "variant\tadd_n\tsub_n\tmul_1\taddmul\tsubmul\tlshift\trshift\tmul\tdiv" << std::endl;
+  for (kernel_variant variant : KERNEL_VARIANTS) {
+    if (!force_kernels(variant)) {
+      continue;
+    }
+    std::vector<double> row;
+    auto kernel_ms = [&](std::function<void()> const& f) {
+      row.push_back(measure_ms([&] {
+        for (int i = 0; i < 10000; i++) {
+          f();
+        }
+      }));
+    };
+    kernel_ms([&] { add_n(r.data(), a.data(), b.data(), n); });
+    kernel_ms([&] { sub_n(r.data(), a.data(), b.data(), n); });
+    kernel_ms([&] { mul_1(r.data(), a.data(), n, b[0]); });
+    kernel_ms([&] { addmul_1(r.data(), a.data(), n, b[0]); });
+    kernel_ms([&] { submul_1(r.data(), a.data(), n, b[0]); });
+    kernel_ms([&] { lshift(r.data(), a.data(), n, 7); });
+    kernel_ms([&] { rshift(r.data(), a.data(), n, 7); });
+    row.push_back(measure_ms([&] { xy = x * y; }));
+    row.push_back(measure_ms([&] { q = xy / x; }));
+    EXPECT_EQ(y, q);
+    std::cout << kernels_of(variant).name;
+    for (double ms : row) {
+      std::cout << '\t' << ms;
+    }
+    std::cout << std::endl;
+  }
+  force_kernels(saved);
+}
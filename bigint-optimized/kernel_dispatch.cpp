@@ -0,0 +1,127 @@
+#include "kernel_dispatch.h"
+#include "limb_kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+
+extern kernel_table const bmi2_adx_kernels;
+extern kernel_table const avx2_kernels;
+extern kernel_table const avx512_kernels;
+extern kernel_table const avx512ifma_kernels;
+#endif
+
+namespace {
+#if defined(__x86_64__)
+// XCR0, the register state the OS saves on context switches
+uint64_t enabled_state() {
+    uint32_t eax, edx;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return static_cast<uint64_t>(edx) << 32u | eax;
+}
+#endif
+
+cpu_features detect_features() {
+    cpu_features features{};
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 7) {
+        return features;
+    }
+    __cpuid(1, eax, ebx, ecx, edx);
+    uint64_t const state = (ecx & bit_OSXSAVE) != 0 ? enabled_state() : 0;
+    bool const ymm = (state & 0x06u) == 0x06u;
+    bool const zmm = (state & 0xe6u) == 0xe6u;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    features.bmi2 = (ebx & bit_BMI2) != 0;
+    features.adx = (ebx & bit_ADX) != 0;
+    features.avx2 = ymm && (ebx & bit_AVX2) != 0;
+    features.avx512f = zmm && (ebx & bit_AVX512F) != 0;
+    features.avx512ifma = features.avx512f && (ebx & bit_AVX512IFMA) != 0;
+#endif
+    return features;
+}
+
+// constant initialized, so the kernels work before bind_at_startup runs
+kernel_table const generic_kernels = {
+    "generic", kernel_variant::generic,
+    add_n_generic, sub_n_generic, mul_1_generic, addmul_1_generic, submul_1_generic,
+    lshift_generic, rshift_generic, mul_basecase_generic, sqr_basecase_generic,
+    and_n_generic, ior_n_generic, xor_n_generic, com_n_generic, equal_n_generic, cmp_n_generic,
+    KARATSUBA_THRESHOLD, SQR_KARATSUBA_THRESHOLD,
+};
+
+bool bind_at_startup() {
+    char const* forced = std::getenv("BIGINT_KERNELS");
+    for (kernel_variant variant : KERNEL_VARIANTS) {
+        if (forced != nullptr && std::strcmp(forced, kernels_of(variant).name) == 0 && force_kernels(variant)) {
+            return true;
+        }
+    }
+    for (kernel_variant variant : KERNEL_VARIANTS) {
+        force_kernels(variant);
+    }
+    return true;
+}
+}
+
+kernel_table const* active_kernels = &generic_kernels;
+
+cpu_features const& host_cpu_features() {
+    static cpu_features const features = detect_features();
+    return features;
+}
+
+kernel_table const& kernels_of(kernel_variant variant) {
+    switch (variant) {
+#if defined(__x86_64__)
+        case kernel_variant::bmi2_adx:
+            return bmi2_adx_kernels;
+        case kernel_variant::avx2:
+            return avx2_kernels;
+        case kernel_variant::avx512:
+            return avx512_kernels;
+        case kernel_variant::avx512ifma:
+            return avx512ifma_kernels;
+#endif
+        default:
+            return generic_kernels;
+    }
+}
+
+bool kernels_supported(kernel_variant variant) {
+    if (variant == kernel_variant::generic) {
+        return true;
+    }
+#if defined(__x86_64__)
+    cpu_features const& features = host_cpu_features();
+    bool const bmi2_adx = features.bmi2 && features.adx;
+    switch (variant) {
+        case kernel_variant::bmi2_adx:
+            return bmi2_adx;
+        case kernel_variant::avx2:
+            return bmi2_adx && features.avx2;
+        case kernel_variant::avx512:
+            return bmi2_adx && features.avx512f;
+        case kernel_variant::avx512ifma:
+            return bmi2_adx && features.avx512ifma;
+        default:
+            break;
+    }
+#endif
+    return false;
+}
+
+bool force_kernels(kernel_variant variant) {
+    if (!kernels_supported(variant)) {
+        return false;
+    }
+    active_kernels = &kernels_of(variant);
+    return true;
+}
+
+namespace {
+bool const bound = bind_at_startup();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Runtime selection of the limb kernels. The host is probed once, during
+// static initialization, and a table of function pointers is bound to the
+// fastest variant it can run.
+
+// Instruction set extensions the kernels can use; the AVX ones also need the
+// OS to save the wider register state.
+struct cpu_features {
+    bool bmi2;
+    bool adx;
+    bool avx2;
+    bool avx512f;
+    bool avx512ifma;
+};
+
+// features of the host, read with CPUID on the first call
+cpu_features const& host_cpu_features();
+
+// The AVX variants pair the bmi2_adx arithmetic with vectorized bitwise and
+// comparison kernels, so they need BMI2 and ADX as well; avx512ifma also
+// multiplies mid-sized operands in radix 2^52.
+enum class kernel_variant {
+    generic,
+    bmi2_adx,
+    avx2,
+    avx512,
+    avx512ifma,
+};
+
+// all variants, slowest first
+kernel_variant const KERNEL_VARIANTS[] = {kernel_variant::generic, kernel_variant::bmi2_adx,
+                                          kernel_variant::avx2, kernel_variant::avx512,
+                                          kernel_variant::avx512ifma};
+
+// One implementation of the kernels of limb_kernels.h, with the same
+// contracts. The wrappers there only call through it for spans of at least
+// DISPATCH_MIN_LIMBS limbs (an for mul_basecase), which entries may assume.
+struct kernel_table {
+    char const* name;
+    kernel_variant variant;
+    uint32_t (*add_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n, uint32_t carry_in);
+    uint32_t (*sub_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    uint32_t (*mul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+    uint32_t (*addmul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+    uint32_t (*submul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+    uint32_t (*lshift)(uint32_t* r, uint32_t const* a, size_t n, unsigned shift);
+    uint32_t (*rshift)(uint32_t* r, uint32_t const* a, size_t n, unsigned shift);
+    void (*mul_basecase)(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn);
+    void (*sqr_basecase)(uint32_t* r, uint32_t const* a, size_t n);
+    void (*and_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    void (*ior_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    void (*xor_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    void (*com_n)(uint32_t* r, uint32_t const* a, size_t n);
+    bool (*equal_n)(uint32_t const* a, uint32_t const* b, size_t n);
+    int (*cmp_n)(uint32_t const* a, uint32_t const* b, size_t n);
+    // operand lengths in limbs from which mul() and sqr() switch to Karatsuba
+    size_t karatsuba_threshold;
+    size_t sqr_karatsuba_threshold;
+};
+
+size_t const DISPATCH_MIN_LIMBS = 8;
+
+// The bound table: the fastest supported variant, or the one named by the
+// BIGINT_KERNELS environment variable ("generic", "bmi2_adx", "avx2",
+// "avx512" or "avx512ifma") if the host supports it.
+extern kernel_table const* active_kernels;
+
+kernel_table const& kernels_of(kernel_variant variant);
+
+bool kernels_supported(kernel_variant variant);
+
+// Binds the given variant, returns false and keeps the current one if the
+// host cannot run it. Must not race with threads that use the kernels.
+bool force_kernels(kernel_variant variant);
@@ -0,0 +1,136 @@
+#include "limb_kernels.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// r[0, n) += a[0, an), an <= n, carry is propagated up to r[n - 1]
+void add_into(uint32_t* r, size_t n, uint32_t const* a, size_t an) {
+    uint32_t const carry = add_n(r, r, a, an);
+    add_1(r + an, r + an, n - an, carry);
+}
+
+void sub_from(uint32_t* r, size_t n, uint32_t const* a, size_t an) {
+    uint32_t const borrow = sub_n(r, r, a, an);
+    sub_1(r + an, r + an, n - an, borrow);
+}
+
+// an >= bn > an / 2
+void mul_karatsuba(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    size_t const h = an / 2;
+    size_t const a1n = an - h;
+    size_t const b1n = bn - h;
+
+    mul(r, a, h, b, h);
+    mul(r + 2 * h, a + h, a1n, b + h, b1n);
+
+    size_t const san = a1n + 1;
+    size_t const sbn = std::max(h, b1n) + 1;
+    std::vector<uint32_t> scratch(san + sbn + san + sbn);
+    uint32_t* sa = scratch.data();
+    uint32_t* sb = sa + san;
+    uint32_t* z1 = sb + sbn;
+
+    std::copy_n(a + h, a1n, sa);
+    add_into(sa, san, a, h);
+    std::copy_n(b, h, sb);
+    add_into(sb, sbn, b + h, b1n);
+
+    mul(z1, sa, san, sb, sbn);
+    sub_from(z1, san + sbn, r, 2 * h);
+    sub_from(z1, san + sbn, r + 2 * h, a1n + b1n);
+
+    size_t z1n = san + sbn;
+    while (z1n > 0 && z1[z1n - 1] == 0) {
+        z1n--;
+    }
+    add_into(r + h, an + bn - h, z1, z1n);
+}
+
+// (a1 B + a0)^2 = a1^2 B^2 + ((a0 + a1)^2 - a0^2 - a1^2) B + a0^2
+void sqr_karatsuba(uint32_t* r, uint32_t const* a, size_t n) {
+    size_t const h = n / 2;
+    size_t const a1n = n - h;
+
+    sqr(r, a, h);
+    sqr(r + 2 * h, a + h, a1n);
+
+    size_t const sn = a1n + 1;
+    std::vector<uint32_t> scratch(3 * sn);
+    uint32_t* sa = scratch.data();
+    uint32_t* z1 = sa + sn;
+
+    std::copy_n(a + h, a1n, sa);
+    add_into(sa, sn, a, h);
+
+    sqr(z1, sa, sn);
+    sub_from(z1, 2 * sn, r, 2 * h);
+    sub_from(z1, 2 * sn, r + 2 * h, 2 * a1n);
+
+    size_t z1n = 2 * sn;
+    while (z1n > 0 && z1[z1n - 1] == 0) {
+        z1n--;
+    }
+    add_into(r + h, 2 * n - h, z1, z1n);
+}
+}
+
+void to_radix52(uint64_t* r, size_t rn, uint32_t const* a, size_t n) {
+    auto limb = [a, n](size_t i) -> uint64_t {
+        return i < n ? a[i] : 0;
+    };
+    for (size_t j = 0; j < rn; j++) {
+        size_t const i = 52 * j / 32;
+        unsigned const shift = 52 * j % 32;
+        uint64_t const low = limb(i) | limb(i + 1) << 32u;
+        r[j] = (low >> shift | (shift > 12 ? limb(i + 2) << (64 - shift) : 0)) & DIGIT52_MASK;
+    }
+}
+
+void from_radix52(uint32_t* r, size_t n, uint64_t const* a, size_t an) {
+    uint64_t window = 0;
+    unsigned bits = 0;
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (bits < 32) {
+            uint64_t const digit = j < an ? a[j++] : 0;
+            r[i] = static_cast<uint32_t>(window | digit << bits);
+            window = digit >> (32 - bits);
+            bits += 20;
+        } else {
+            r[i] = static_cast<uint32_t>(window);
+            window >>= 32u;
+            bits -= 32;
+        }
+    }
+}
+
+void mul(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn < active_kernels->karatsuba_threshold) {
+        mul_basecase(r, a, an, b, bn);
+    } else if (an < 2 * bn) {
+        mul_karatsuba(r, a, an, b, bn);
+    } else {
+        // unbalanced: multiply b by bn-sized slices of a
+        std::vector<uint32_t> slice(2 * bn);
+        std::fill_n(r, an + bn, 0);
+        for (size_t i = 0; i < an; i += bn) {
+            size_t const len = std::min(bn, an - i);
+            mul(slice.data(), a + i, len, b, bn);
+            add_into(r + i, an + bn - i, slice.data(), len + bn);
+        }
+    }
+}
+
+void sqr(uint32_t* r, uint32_t const* a, size_t n) {
+    if (n < active_kernels->sqr_karatsuba_threshold) {
+        sqr_basecase(r, a, n);
+    } else {
+        sqr_karatsuba(r, a, n);
+    }
+}
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "kernel_dispatch.h"
+
+// Loops over little-endian spans of 32-bit limbs. Output may alias an input
+// only when it starts at the same address.
+
+// Portable loops; they make up the generic kernel variant and handle the
+// spans too short to be dispatched.
+
+inline uint32_t add_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n, uint32_t carry_in) {
+    uint64_t carry = carry_in;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const res = static_cast<uint64_t>(a[i]) + b[i] + carry;
+        r[i] = static_cast<uint32_t>(res);
+        carry = res >> 32u;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+inline uint32_t sub_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const res = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<uint32_t>(res);
+        borrow = static_cast<uint32_t>(res >> 63u);
+    }
+    return borrow;
+}
+
+inline uint32_t mul_1_generic(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const res = static_cast<uint64_t>(a[i]) * b + carry;
+        r[i] = static_cast<uint32_t>(res);
+        carry = res >> 32u;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+inline uint32_t addmul_1_generic(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const res = static_cast<uint64_t>(a[i]) * b + r[i] + carry;
+        r[i] = static_cast<uint32_t>(res);
+        carry = res >> 32u;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+inline uint32_t submul_1_generic(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const product = static_cast<uint64_t>(a[i]) * b + borrow;
+        uint32_t const low = static_cast<uint32_t>(product);
+        borrow = (product >> 32u) + (r[i] < low);
+        r[i] -= low;
+    }
+    return static_cast<uint32_t>(borrow);
+}
+
+inline uint32_t lshift_generic(uint32_t* r, uint32_t const* a, size_t n, unsigned shift) {
+    uint32_t const out = a[n - 1] >> (32 - shift);
+    for (size_t i = n - 1; i > 0; i--) {
+        r[i] = a[i] << shift | a[i - 1] >> (32 - shift);
+    }
+    r[0] = a[0] << shift;
+    return out;
+}
+
+inline uint32_t rshift_generic(uint32_t* r, uint32_t const* a, size_t n, unsigned shift) {
+    uint32_t const out = a[0] << (32 - shift);
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i] = a[i] >> shift | a[i + 1] << (32 - shift);
+    }
+    r[n - 1] = a[n - 1] >> shift;
+    return out;
+}
+
+inline void mul_basecase_generic(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    r[an] = mul_1_generic(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; j++) {
+        r[an + j] = addmul_1_generic(r + j, a, an, b[j]);
+    }
+}
+
+inline void and_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = a[i] & b[i];
+    }
+}
+
+inline void ior_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = a[i] | b[i];
+    }
+}
+
+inline void xor_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = a[i] ^ b[i];
+    }
+}
+
+inline void com_n_generic(uint32_t* r, uint32_t const* a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = ~a[i];
+    }
+}
+
+inline bool equal_n_generic(uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline int cmp_n_generic(uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// r = a + b + carry, returns carry
+inline uint32_t add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n, uint32_t carry_in = 0) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return add_n_generic(r, a, b, n, carry_in);
+    }
+    return active_kernels->add_n(r, a, b, n, carry_in);
+}
+
+// r = a + b for a single limb b, returns carry
+inline uint32_t add_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t carry = b;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const res = static_cast<uint64_t>(a[i]) + carry;
+        r[i] = static_cast<uint32_t>(res);
+        carry = res >> 32u;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+// two independent sums r0 = a0 + b0 and r1 = a1 + b1 in one loop, so that
+// both carry chains are in flight at once
+inline void add_n_x2(uint32_t* r0, uint32_t const* a0, uint32_t const* b0, uint32_t& carry0,
+                     uint32_t* r1, uint32_t const* a1, uint32_t const* b1, uint32_t& carry1,
+                     size_t n) {
+    uint64_t c0 = carry0, c1 = carry1;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const s0 = static_cast<uint64_t>(a0[i]) + b0[i] + c0;
+        uint64_t const s1 = static_cast<uint64_t>(a1[i]) + b1[i] + c1;
+        r0[i] = static_cast<uint32_t>(s0);
+        r1[i] = static_cast<uint32_t>(s1);
+        c0 = s0 >> 32u;
+        c1 = s1 >> 32u;
+    }
+    carry0 = static_cast<uint32_t>(c0);
+    carry1 = static_cast<uint32_t>(c1);
+}
+
+// r = a - b, returns borrow
+inline uint32_t sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return sub_n_generic(r, a, b, n);
+    }
+    return active_kernels->sub_n(r, a, b, n);
+}
+
+// r = a - b for a single limb b, returns borrow
+inline uint32_t sub_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint32_t borrow = b;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const res = static_cast<uint64_t>(a[i]) - borrow;
+        r[i] = static_cast<uint32_t>(res);
+        borrow = static_cast<uint32_t>(res >> 63u);
+    }
+    return borrow;
+}
+
+// r = a * b, returns high limb
+inline uint32_t mul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return mul_1_generic(r, a, n, b);
+    }
+    return active_kernels->mul_1(r, a, n, b);
+}
+
+// r += a * b, returns high limb
+inline uint32_t addmul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return addmul_1_generic(r, a, n, b);
+    }
+    return active_kernels->addmul_1(r, a, n, b);
+}
+
+// r -= a * b, returns borrow limb
+inline uint32_t submul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return submul_1_generic(r, a, n, b);
+    }
+    return active_kernels->submul_1(r, a, n, b);
+}
+
+// r = a << shift for 0 < shift < 32, returns bits shifted out; r may also
+// start above a
+inline uint32_t lshift(uint32_t* r, uint32_t const* a, size_t n, unsigned shift) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return lshift_generic(r, a, n, shift);
+    }
+    return active_kernels->lshift(r, a, n, shift);
+}
+
+// r = a >> shift for 0 < shift < 32, returns bits shifted out in the high
+// bits; r may also start below a
+inline uint32_t rshift(uint32_t* r, uint32_t const* a, size_t n, unsigned shift) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return rshift_generic(r, a, n, shift);
+    }
+    return active_kernels->rshift(r, a, n, shift);
+}
+
+// r = a * b, r has an + bn limbs and overlaps neither input
+inline void mul_basecase(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (an < DISPATCH_MIN_LIMBS) {
+        mul_basecase_generic(r, a, an, b, bn);
+        return;
+    }
+    active_kernels->mul_basecase(r, a, an, b, bn);
+}
+
+// every cross product a[i] * a[j] is computed once and doubled; the rows
+// go through the dispatched addmul_1
+inline void sqr_basecase_generic(uint32_t* r, uint32_t const* a, size_t n) {
+    std::fill_n(r, 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
+    uint32_t high_bit = 0;
+    for (size_t i = 0; i < 2 * n; i++) {
+        uint32_t const next = r[i] >> 31u;
+        r[i] = r[i] << 1u | high_bit;
+        high_bit = next;
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const square = static_cast<uint64_t>(a[i]) * a[i];
+        uint64_t const low = r[2 * i] + (square & UINT32_MAX) + carry;
+        r[2 * i] = static_cast<uint32_t>(low);
+        uint64_t const high = r[2 * i + 1] + (square >> 32u) + (low >> 32u);
+        r[2 * i + 1] = static_cast<uint32_t>(high);
+        carry = high >> 32u;
+    }
+}
+
+// r = a^2, r has 2n limbs and does not overlap a
+inline void sqr_basecase(uint32_t* r, uint32_t const* a, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        sqr_basecase_generic(r, a, n);
+        return;
+    }
+    active_kernels->sqr_basecase(r, a, n);
+}
+
+// r = a & b
+inline void and_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        and_n_generic(r, a, b, n);
+        return;
+    }
+    active_kernels->and_n(r, a, b, n);
+}
+
+// r = a | b
+inline void ior_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        ior_n_generic(r, a, b, n);
+        return;
+    }
+    active_kernels->ior_n(r, a, b, n);
+}
+
+// r = a ^ b
+inline void xor_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        xor_n_generic(r, a, b, n);
+        return;
+    }
+    active_kernels->xor_n(r, a, b, n);
+}
+
+// r = ~a
+inline void com_n(uint32_t* r, uint32_t const* a, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        com_n_generic(r, a, n);
+        return;
+    }
+    active_kernels->com_n(r, a, n);
+}
+
+// whether a and b hold the same limbs
+inline bool equal_n(uint32_t const* a, uint32_t const* b, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return equal_n_generic(a, b, n);
+    }
+    return active_kernels->equal_n(a, b, n);
+}
+
+// sign of a - b, decided by the highest differing limb
+inline int cmp_n(uint32_t const* a, uint32_t const* b, size_t n) {
+    if (n < DISPATCH_MIN_LIMBS) {
+        return cmp_n_generic(a, b, n);
+    }
+    return active_kernels->cmp_n(a, b, n);
+}
+
+// remainder of a divided by a single nonzero limb
+inline uint32_t mod_1(uint32_t const* a, size_t n, uint32_t d) {
+    uint64_t rem = 0;
+    for (size_t i = n; i-- > 0;) {
+        rem = ((rem << 32u) | a[i]) % d;
+    }
+    return static_cast<uint32_t>(rem);
+}
+
+// -m^-1 mod 2^32 for odd m
+inline uint32_t inverse_limb(uint32_t m) {
+    uint32_t x = m;
+    for (int i = 0; i < 4; i++) {
+        x *= 2 - m * x;
+    }
+    return -x;
+}
+
+// Montgomery reduction r = t / 2^(32n) mod m, t has 2n limbs and is
+// destroyed, m_inv = -m^-1 mod 2^32, t < m * 2^(32n)
+inline void redc(uint32_t* r, uint32_t* t, uint32_t const* m, size_t n, uint32_t m_inv) {
+    uint32_t top = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t const carry = addmul_1(t + i, m, n, t[i] * m_inv);
+        uint64_t const res = static_cast<uint64_t>(t[i + n]) + carry + top;
+        t[i + n] = static_cast<uint32_t>(res);
+        top = static_cast<uint32_t>(res >> 32u);
+    }
+    bool subtract = top != 0;
+    if (!subtract) {
+        size_t i = n;
+        while (i > 0 && t[n + i - 1] == m[i - 1]) {
+            i--;
+        }
+        subtract = i == 0 || t[n + i - 1] > m[i - 1];
+    }
+    if (subtract) {
+        sub_n(r, t + n, m, n);
+    } else {
+        std::copy_n(t + n, n, r);
+    }
+}
+
+// Radix 2^52 digits, 52 bits in each uint64_t, as used by the AVX-512 IFMA
+// kernels
+
+uint64_t const DIGIT52_MASK = (static_cast<uint64_t>(1) << 52u) - 1;
+
+// 52-bit digits needed for n limbs
+inline size_t digits52(size_t n) {
+    return (32 * n + 51) / 52;
+}
+
+// -m^-1 mod 2^52 for odd m
+inline uint64_t inverse_digit52(uint64_t m) {
+    uint64_t x = m;
+    for (int i = 0; i < 5; i++) {
+        x *= 2 - m * x;
+    }
+    return -x & DIGIT52_MASK;
+}
+
+// r = a as rn digits, bits above 52 rn are dropped
+void to_radix52(uint64_t* r, size_t rn, uint32_t const* a, size_t n);
+
+// r = a as n limbs for normalized digits a, bits above 32 n are dropped
+void from_radix52(uint32_t* r, size_t n, uint64_t const* a, size_t an);
+
+#if defined(__x86_64__)
+// r = a * b / 2^(52n) mod m on n normalized digits, for odd m and a, b < m;
+// m_inv = -m^-1 mod 2^52, scratch holds 2n + 16 digits, r may alias a or b.
+// Needs AVX-512 IFMA and n <= IFMA_MAX_DIGITS.
+void mont_mul_ifma(uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t const* m, size_t n,
+                   uint64_t m_inv, uint64_t* scratch);
+
+// longest operands of the IFMA kernels in digits. Carries are propagated only
+// at the end: a lane of mul_ifma gathers up to one 52-bit term per digit of
+// the shorter operand, and a digit of mont_mul_ifma up to 4n over the loop,
+// and 4 * 1000 * 2^52 < 2^64 keeps both from overflowing
+size_t const IFMA_MAX_DIGITS = 1000;
+#endif
+
+size_t const KARATSUBA_THRESHOLD = 40;
+size_t const SQR_KARATSUBA_THRESHOLD = 64;
+
+// r = a * b, r has an + bn limbs and overlaps neither input; switches to
+// Karatsuba once both operands reach the threshold of the bound kernels
+void mul(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn);
+
+// r = a^2, r has 2n limbs and does not overlap a
+void sqr(uint32_t* r, uint32_t const* a, size_t n);
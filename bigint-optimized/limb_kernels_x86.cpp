@@ -0,0 +1,575 @@
+#include "limb_kernels.h"
+
+#if defined(__x86_64__)
+
+#include "kernels.h"
+
+#include <cstring>
+#include <immintrin.h>
+#include <vector>
+
+#if !defined(BIGINT_ASM_KERNELS)
+
+// Without nasm the kernels of asm/kernels.asm are built from intrinsics. Limbs
+// are read and written through memcpy, since callers pass arrays of 32-bit
+// limbs viewed as 64-bit ones.
+
+namespace {
+inline unsigned long long load(uint64_t const* p, size_t i) {
+    unsigned long long x;
+    std::memcpy(&x, p + i, sizeof(x));
+    return x;
+}
+
+inline void store(uint64_t* p, size_t i, unsigned long long x) {
+    std::memcpy(p + i, &x, sizeof(x));
+}
+}
+
+#define BMI2_ADX __attribute__((target("bmi2,adx")))
+
+BMI2_ADX uint64_t bigint_add_n(uint64_t* r, uint64_t const* a, uint64_t const* b, size_t n) {
+    unsigned char carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long s;
+        carry = _addcarry_u64(carry, load(a, i), load(b, i), &s);
+        store(r, i, s);
+    }
+    return carry;
+}
+
+BMI2_ADX uint64_t bigint_sub_n(uint64_t* r, uint64_t const* a, uint64_t const* b, size_t n) {
+    unsigned char borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long s;
+        borrow = _subborrow_u64(borrow, load(a, i), load(b, i), &s);
+        store(r, i, s);
+    }
+    return borrow;
+}
+
+BMI2_ADX uint64_t bigint_mul_1(uint64_t* r, uint64_t const* a, size_t n, uint64_t b) {
+    unsigned long long high = 0;
+    unsigned char carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long next, low = _mulx_u64(load(a, i), b, &next);
+        carry = _addcarryx_u64(carry, low, high, &low);
+        store(r, i, low);
+        high = next;
+    }
+    return high + carry;
+}
+
+BMI2_ADX uint64_t bigint_addmul_1(uint64_t* r, uint64_t const* a, size_t n, uint64_t b) {
+    unsigned long long high = 0;
+    unsigned char carry = 0, overflow = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long next, low = _mulx_u64(load(a, i), b, &next);
+        carry = _addcarryx_u64(carry, low, high, &low);
+        overflow = _addcarryx_u64(overflow, low, load(r, i), &low);
+        store(r, i, low);
+        high = next;
+    }
+    return high + carry + overflow;
+}
+
+BMI2_ADX uint64_t bigint_submul_1(uint64_t* r, uint64_t const* a, size_t n, uint64_t b) {
+    unsigned long long high = 0;
+    unsigned char carry = 0, borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long next, low = _mulx_u64(load(a, i), b, &next);
+        carry = _addcarryx_u64(carry, low, high, &low);
+        borrow = _subborrow_u64(borrow, load(r, i), low, &low);
+        store(r, i, low);
+        high = next;
+    }
+    return high + carry + borrow;
+}
+
+uint64_t bigint_lshift(uint64_t* r, uint64_t const* a, size_t n, unsigned shift) {
+    unsigned long long const out = load(a, n - 1) >> (64 - shift);
+    for (size_t i = n - 1; i > 0; i--) {
+        store(r, i, load(a, i) << shift | load(a, i - 1) >> (64 - shift));
+    }
+    store(r, 0, load(a, 0) << shift);
+    return out;
+}
+
+uint64_t bigint_rshift(uint64_t* r, uint64_t const* a, size_t n, unsigned shift) {
+    unsigned long long const out = load(a, 0) << (64 - shift);
+    for (size_t i = 0; i + 1 < n; i++) {
+        store(r, i, load(a, i) >> shift | load(a, i + 1) << (64 - shift));
+    }
+    store(r, n - 1, load(a, n - 1) >> shift);
+    return out;
+}
+
+#endif
+
+// The bmi2_adx variant views spans of 32-bit limbs as 64-bit limbs for the
+// kernels above and finishes an odd top limb with the portable loops.
+
+namespace {
+inline uint64_t* as_limbs64(uint32_t* p) {
+    return reinterpret_cast<uint64_t*>(p);
+}
+
+inline uint64_t const* as_limbs64(uint32_t const* p) {
+    return reinterpret_cast<uint64_t const*>(p);
+}
+
+// i-th 64-bit limb of a
+inline uint64_t load_limb64(uint32_t const* a, size_t i) {
+    uint64_t x;
+    std::memcpy(&x, a + 2 * i, sizeof(x));
+    return x;
+}
+
+uint32_t add_n_bmi2_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n, uint32_t carry_in) {
+    if (carry_in != 0) {
+        return add_n_generic(r, a, b, n, carry_in);
+    }
+    uint32_t const carry = static_cast<uint32_t>(bigint_add_n(as_limbs64(r), as_limbs64(a), as_limbs64(b), n / 2));
+    size_t const i = n - n % 2;
+    return add_n_generic(r + i, a + i, b + i, n - i, carry);
+}
+
+uint32_t sub_n_bmi2_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    uint32_t borrow = static_cast<uint32_t>(bigint_sub_n(as_limbs64(r), as_limbs64(a), as_limbs64(b), n / 2));
+    if (n % 2 == 1) {
+        uint64_t const res = static_cast<uint64_t>(a[n - 1]) - b[n - 1] - borrow;
+        r[n - 1] = static_cast<uint32_t>(res);
+        borrow = static_cast<uint32_t>(res >> 63u);
+    }
+    return borrow;
+}
+
+// the high limb of a 64 x 32-bit product is below 2^32
+uint32_t mul_1_bmi2_adx(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t carry = bigint_mul_1(as_limbs64(r), as_limbs64(a), n / 2, b);
+    if (n % 2 == 1) {
+        carry += static_cast<uint64_t>(a[n - 1]) * b;
+        r[n - 1] = static_cast<uint32_t>(carry);
+        carry >>= 32u;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t addmul_1_bmi2_adx(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t carry = bigint_addmul_1(as_limbs64(r), as_limbs64(a), n / 2, b);
+    if (n % 2 == 1) {
+        carry += static_cast<uint64_t>(a[n - 1]) * b + r[n - 1];
+        r[n - 1] = static_cast<uint32_t>(carry);
+        carry >>= 32u;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t submul_1_bmi2_adx(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t borrow = bigint_submul_1(as_limbs64(r), as_limbs64(a), n / 2, b);
+    if (n % 2 == 1) {
+        uint64_t const product = static_cast<uint64_t>(a[n - 1]) * b + borrow;
+        uint32_t const low = static_cast<uint32_t>(product);
+        borrow = (product >> 32u) + (r[n - 1] < low);
+        r[n - 1] -= low;
+    }
+    return static_cast<uint32_t>(borrow);
+}
+
+uint32_t lshift_bmi2_adx(uint32_t* r, uint32_t const* a, size_t n, unsigned shift) {
+    uint32_t const out = a[n - 1] >> (32 - shift);
+    size_t i = n - 1;
+    if (n % 2 == 1) {
+        r[n - 1] = a[n - 1] << shift | a[n - 2] >> (32 - shift);
+        i = n - 2;
+    }
+    // a[0] << shift as a 64-bit limb has zeros below the shifted bits
+    bigint_lshift(as_limbs64(r), as_limbs64(a), (i + 1) / 2, shift);
+    return out;
+}
+
+uint32_t rshift_bmi2_adx(uint32_t* r, uint32_t const* a, size_t n, unsigned shift) {
+    uint32_t const out = a[0] << (32 - shift);
+    // the top limb of each 64-bit limb takes bits of the next one, so only
+    // the last 32-bit limb is left
+    size_t const pairs = (n - 1) / 2;
+    bigint_rshift(as_limbs64(r), as_limbs64(a), pairs, shift);
+    r[2 * pairs - 1] |= a[2 * pairs] << (32 - shift);
+    if (n % 2 == 0) {
+        r[n - 2] = a[n - 2] >> shift | a[n - 1] << (32 - shift);
+    }
+    r[n - 1] = a[n - 1] >> shift;
+    return out;
+}
+
+// rows of 64-bit limbs for the even parts, then a row for each odd top limb
+void mul_basecase_bmi2_adx(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (bn < 2) {
+        mul_basecase_generic(r, a, an, b, bn);
+        return;
+    }
+    size_t const an2 = an / 2, bn2 = bn / 2;
+    uint64_t* r64 = as_limbs64(r);
+    uint64_t const* a64 = as_limbs64(a);
+    uint64_t top = bigint_mul_1(r64, a64, an2, load_limb64(b, 0));
+    std::memcpy(r + 2 * an2, &top, sizeof(top));
+    for (size_t j = 1; j < bn2; j++) {
+        top = bigint_addmul_1(r64 + j, a64, an2, load_limb64(b, j));
+        std::memcpy(r + 2 * (an2 + j), &top, sizeof(top));
+    }
+    if (an % 2 == 1) {
+        r[an - 1 + 2 * bn2] = addmul_1(r + an - 1, b, 2 * bn2, a[an - 1]);
+    }
+    if (bn % 2 == 1) {
+        r[an + bn - 1] = addmul_1_bmi2_adx(r + bn - 1, a, an, b[bn - 1]);
+    }
+}
+}
+
+// Bitwise and comparison kernels on 8 limbs (AVX2) or 16 limbs (AVX-512) at a
+// time. Loads are unaligned; AVX-512 finishes a span with masked accesses,
+// which do not touch the limbs past its end.
+
+#define AVX2 __attribute__((target("avx2")))
+#define AVX512 __attribute__((target("avx512f")))
+
+namespace {
+AVX2 inline __m256i load256(uint32_t const* p) {
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+}
+
+AVX2 inline void store256(uint32_t* p, __m256i x) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+}
+
+inline __mmask16 tail_mask(size_t n) {
+    return static_cast<__mmask16>((1u << n) - 1);
+}
+
+struct and_op {
+    static uint32_t limb(uint32_t a, uint32_t b) {
+        return a & b;
+    }
+    AVX2 static __m256i avx2(__m256i a, __m256i b) {
+        return _mm256_and_si256(a, b);
+    }
+    AVX512 static __m512i avx512(__m512i a, __m512i b) {
+        return _mm512_and_si512(a, b);
+    }
+};
+
+struct ior_op {
+    static uint32_t limb(uint32_t a, uint32_t b) {
+        return a | b;
+    }
+    AVX2 static __m256i avx2(__m256i a, __m256i b) {
+        return _mm256_or_si256(a, b);
+    }
+    AVX512 static __m512i avx512(__m512i a, __m512i b) {
+        return _mm512_or_si512(a, b);
+    }
+};
+
+struct xor_op {
+    static uint32_t limb(uint32_t a, uint32_t b) {
+        return a ^ b;
+    }
+    AVX2 static __m256i avx2(__m256i a, __m256i b) {
+        return _mm256_xor_si256(a, b);
+    }
+    AVX512 static __m512i avx512(__m512i a, __m512i b) {
+        return _mm512_xor_si512(a, b);
+    }
+};
+
+template <typename Op>
+AVX2 void bitwise_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        store256(r + i, Op::avx2(load256(a + i), load256(b + i)));
+    }
+    for (; i < n; i++) {
+        r[i] = Op::limb(a[i], b[i]);
+    }
+}
+
+AVX2 void com_n_avx2(uint32_t* r, uint32_t const* a, size_t n) {
+    __m256i const ones = _mm256_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        store256(r + i, _mm256_xor_si256(load256(a + i), ones));
+    }
+    com_n_generic(r + i, a + i, n - i);
+}
+
+AVX2 bool equal_n_avx2(uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i const diff = _mm256_xor_si256(load256(a + i), load256(b + i));
+        if (!_mm256_testz_si256(diff, diff)) {
+            return false;
+        }
+    }
+    return equal_n_generic(a + i, b + i, n - i);
+}
+
+// blocks of 8 limbs from the top; the highest lane that differs decides
+AVX2 int cmp_n_avx2(uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = n;
+    for (; i >= 8; i -= 8) {
+        __m256i const equal = _mm256_cmpeq_epi32(load256(a + i - 8), load256(b + i - 8));
+        unsigned const diff = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) & 0xffu;
+        if (diff != 0) {
+            size_t const top = i - 8 + 31 - __builtin_clz(diff);
+            return a[top] < b[top] ? -1 : 1;
+        }
+    }
+    return cmp_n_generic(a, b, i);
+}
+
+template <typename Op>
+AVX512 void bitwise_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_si512(r + i, Op::avx512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+    }
+    if (i < n) {
+        __mmask16 const tail = tail_mask(n - i);
+        __m512i const x = _mm512_maskz_loadu_epi32(tail, a + i), y = _mm512_maskz_loadu_epi32(tail, b + i);
+        _mm512_mask_storeu_epi32(r + i, tail, Op::avx512(x, y));
+    }
+}
+
+AVX512 void com_n_avx512(uint32_t* r, uint32_t const* a, size_t n) {
+    __m512i const ones = _mm512_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_si512(r + i, _mm512_xor_si512(_mm512_loadu_si512(a + i), ones));
+    }
+    if (i < n) {
+        __mmask16 const tail = tail_mask(n - i);
+        _mm512_mask_storeu_epi32(r + i, tail, _mm512_xor_si512(_mm512_maskz_loadu_epi32(tail, a + i), ones));
+    }
+}
+
+AVX512 bool equal_n_avx512(uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        if (_mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)) != 0) {
+            return false;
+        }
+    }
+    if (i < n) {
+        __mmask16 const tail = tail_mask(n - i);
+        __m512i const x = _mm512_maskz_loadu_epi32(tail, a + i), y = _mm512_maskz_loadu_epi32(tail, b + i);
+        return _mm512_cmpneq_epi32_mask(x, y) == 0;
+    }
+    return true;
+}
+
+AVX512 int cmp_n_avx512(uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = n;
+    for (; i >= 16; i -= 16) {
+        unsigned const diff = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a + i - 16), _mm512_loadu_si512(b + i - 16));
+        if (diff != 0) {
+            size_t const top = i - 16 + 31 - __builtin_clz(diff);
+            return a[top] < b[top] ? -1 : 1;
+        }
+    }
+    if (i > 0) {
+        __mmask16 const tail = tail_mask(i);
+        unsigned const diff = _mm512_cmpneq_epi32_mask(_mm512_maskz_loadu_epi32(tail, a), _mm512_maskz_loadu_epi32(tail, b));
+        if (diff != 0) {
+            size_t const top = 31 - __builtin_clz(diff);
+            return a[top] < b[top] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+}
+
+// Radix 2^52 multiplication with VPMADD52LUQ/VPMADD52HUQ, which add the low
+// and the high 52 bits of digit products to 64-bit lanes. For operands of up
+// to IFMA_MAX_DIGITS digits the lanes cannot overflow, so carries are only
+// propagated at the end.
+
+#define IFMA __attribute__((target("avx512f,avx512ifma")))
+
+namespace {
+size_t const IFMA_MIN_LIMBS = 24;
+size_t const IFMA_KARATSUBA_THRESHOLD = 800;
+// the product kernel keeps 4 blocks of 8 output digits in registers
+size_t const IFMA_BLOCK = 32;
+
+// r = a * b through radix 2^52, an >= bn, bn <= IFMA_MAX_DIGITS digits
+IFMA void mul_ifma(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    size_t const ma = digits52(an), mb = digits52(bn);
+    size_t const mr = (ma + mb + IFMA_BLOCK - 1) / IFMA_BLOCK * IFMA_BLOCK;
+    // a is padded with a block of zeros on both sides, so that every window
+    // of a block that overlaps it can be loaded
+    std::vector<uint64_t> buffer(ma + 2 * IFMA_BLOCK + mb + 2 * mr);
+    uint64_t* ad = buffer.data() + IFMA_BLOCK;
+    uint64_t* bd = ad + ma + IFMA_BLOCK;
+    uint64_t* low = bd + mb;
+    uint64_t* high = low + mr;
+    to_radix52(ad, ma, a, an);
+    to_radix52(bd, mb, b, bn);
+
+    for (size_t p = 0; p < ma + mb; p += IFMA_BLOCK) {
+        __m512i lo0 = _mm512_setzero_si512(), lo1 = lo0, lo2 = lo0, lo3 = lo0;
+        __m512i hi0 = lo0, hi1 = lo0, hi2 = lo0, hi3 = lo0;
+        size_t const first = p + 1 > ma ? p + 1 - ma : 0;
+        size_t const last = std::min(mb, p + IFMA_BLOCK);
+        for (size_t j = first; j < last; j++) {
+            __m512i const y = _mm512_set1_epi64(static_cast<long long>(bd[j]));
+            uint64_t const* x = ad + p - j;
+            __m512i const x0 = _mm512_loadu_si512(x), x1 = _mm512_loadu_si512(x + 8);
+            __m512i const x2 = _mm512_loadu_si512(x + 16), x3 = _mm512_loadu_si512(x + 24);
+            lo0 = _mm512_madd52lo_epu64(lo0, x0, y);
+            hi0 = _mm512_madd52hi_epu64(hi0, x0, y);
+            lo1 = _mm512_madd52lo_epu64(lo1, x1, y);
+            hi1 = _mm512_madd52hi_epu64(hi1, x1, y);
+            lo2 = _mm512_madd52lo_epu64(lo2, x2, y);
+            hi2 = _mm512_madd52hi_epu64(hi2, x2, y);
+            lo3 = _mm512_madd52lo_epu64(lo3, x3, y);
+            hi3 = _mm512_madd52hi_epu64(hi3, x3, y);
+        }
+        _mm512_storeu_si512(low + p, lo0);
+        _mm512_storeu_si512(low + p + 8, lo1);
+        _mm512_storeu_si512(low + p + 16, lo2);
+        _mm512_storeu_si512(low + p + 24, lo3);
+        _mm512_storeu_si512(high + p, hi0);
+        _mm512_storeu_si512(high + p + 8, hi1);
+        _mm512_storeu_si512(high + p + 16, hi2);
+        _mm512_storeu_si512(high + p + 24, hi3);
+    }
+
+    // the high half of a product at digit q belongs to digit q + 1
+    uint64_t carry = 0;
+    for (size_t q = 0; q < ma + mb; q++) {
+        uint64_t const v = low[q] + (q > 0 ? high[q - 1] : 0) + carry;
+        low[q] = v & DIGIT52_MASK;
+        carry = v >> 52u;
+    }
+    from_radix52(r, an + bn, low, ma + mb);
+}
+
+void mul_basecase_ifma(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn < IFMA_MIN_LIMBS || digits52(bn) > IFMA_MAX_DIGITS) {
+        mul_basecase_bmi2_adx(r, a, an, b, bn);
+        return;
+    }
+    mul_ifma(r, a, an, b, bn);
+}
+
+// the product kernel has no separate squaring; it still beats the limb
+// squaring from IFMA_MIN_LIMBS on
+void sqr_basecase_ifma(uint32_t* r, uint32_t const* a, size_t n) {
+    if (n < IFMA_MIN_LIMBS || digits52(n) > IFMA_MAX_DIGITS) {
+        sqr_basecase_generic(r, a, n);
+        return;
+    }
+    mul_ifma(r, a, n, a, n);
+}
+}
+
+// Almost Montgomery multiplication, one digit of b per step on a window of t
+// that moves up by a digit: the low halves go in first, so that q is known,
+// then the high halves one digit up. Only the result is normalized.
+IFMA void mont_mul_ifma(uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t const* m, size_t n,
+                        uint64_t m_inv, uint64_t* scratch) {
+    size_t const vectors = (n + 7) / 8;
+    __mmask8 const tail = static_cast<__mmask8>(0xffu >> (8 * vectors - n));
+    uint64_t* t = scratch;
+    std::fill_n(t, 2 * n + 16, 0);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t* w = t + i;
+        __m512i const y = _mm512_set1_epi64(static_cast<long long>(b[i]));
+        uint64_t const q = ((w[0] + a[0] * b[i]) * m_inv) & DIGIT52_MASK;
+        __m512i const z = _mm512_set1_epi64(static_cast<long long>(q));
+        for (size_t v = 0; v < vectors; v++) {
+            __mmask8 const mask = v + 1 < vectors ? 0xff : tail;
+            __m512i const x = _mm512_maskz_loadu_epi64(mask, a + 8 * v);
+            __m512i const d = _mm512_maskz_loadu_epi64(mask, m + 8 * v);
+            __m512i acc = _mm512_loadu_si512(w + 8 * v);
+            acc = _mm512_madd52lo_epu64(acc, x, y);
+            acc = _mm512_madd52lo_epu64(acc, d, z);
+            _mm512_storeu_si512(w + 8 * v, acc);
+        }
+        w[1] += w[0] >> 52u;
+        for (size_t v = 0; v < vectors; v++) {
+            __mmask8 const mask = v + 1 < vectors ? 0xff : tail;
+            __m512i const x = _mm512_maskz_loadu_epi64(mask, a + 8 * v);
+            __m512i const d = _mm512_maskz_loadu_epi64(mask, m + 8 * v);
+            __m512i acc = _mm512_loadu_si512(w + 8 * v + 1);
+            acc = _mm512_madd52hi_epu64(acc, x, y);
+            acc = _mm512_madd52hi_epu64(acc, d, z);
+            _mm512_storeu_si512(w + 8 * v + 1, acc);
+        }
+    }
+
+    // t / 2^(52n) < 2m, normalized into n + 1 digits
+    uint64_t* u = t + n;
+    uint64_t carry = 0;
+    for (size_t q = 0; q <= n; q++) {
+        uint64_t const v = u[q] + carry;
+        u[q] = v & DIGIT52_MASK;
+        carry = v >> 52u;
+    }
+    bool subtract = u[n] != 0;
+    if (!subtract) {
+        size_t i = n;
+        while (i > 0 && u[i - 1] == m[i - 1]) {
+            i--;
+        }
+        subtract = i == 0 || u[i - 1] > m[i - 1];
+    }
+    if (!subtract) {
+        std::copy_n(u, n, r);
+        return;
+    }
+    uint64_t borrow = 0;
+    for (size_t q = 0; q < n; q++) {
+        uint64_t const v = u[q] - m[q] - borrow;
+        r[q] = v & DIGIT52_MASK;
+        borrow = v >> 63u;
+    }
+}
+
+extern kernel_table const bmi2_adx_kernels = {
+    "bmi2_adx", kernel_variant::bmi2_adx,
+    add_n_bmi2_adx, sub_n_bmi2_adx, mul_1_bmi2_adx, addmul_1_bmi2_adx, submul_1_bmi2_adx,
+    lshift_bmi2_adx, rshift_bmi2_adx, mul_basecase_bmi2_adx, sqr_basecase_generic,
+    and_n_generic, ior_n_generic, xor_n_generic, com_n_generic, equal_n_generic, cmp_n_generic,
+    KARATSUBA_THRESHOLD, SQR_KARATSUBA_THRESHOLD,
+};
+
+extern kernel_table const avx2_kernels = {
+    "avx2", kernel_variant::avx2,
+    add_n_bmi2_adx, sub_n_bmi2_adx, mul_1_bmi2_adx, addmul_1_bmi2_adx, submul_1_bmi2_adx,
+    lshift_bmi2_adx, rshift_bmi2_adx, mul_basecase_bmi2_adx, sqr_basecase_generic,
+    bitwise_avx2<and_op>, bitwise_avx2<ior_op>, bitwise_avx2<xor_op>, com_n_avx2, equal_n_avx2, cmp_n_avx2,
+    KARATSUBA_THRESHOLD, SQR_KARATSUBA_THRESHOLD,
+};
+
+extern kernel_table const avx512_kernels = {
+    "avx512", kernel_variant::avx512,
+    add_n_bmi2_adx, sub_n_bmi2_adx, mul_1_bmi2_adx, addmul_1_bmi2_adx, submul_1_bmi2_adx,
+    lshift_bmi2_adx, rshift_bmi2_adx, mul_basecase_bmi2_adx, sqr_basecase_generic,
+    bitwise_avx512<and_op>, bitwise_avx512<ior_op>, bitwise_avx512<xor_op>, com_n_avx512, equal_n_avx512, cmp_n_avx512,
+    KARATSUBA_THRESHOLD, SQR_KARATSUBA_THRESHOLD,
+};
+
+extern kernel_table const avx512ifma_kernels = {
+    "avx512ifma", kernel_variant::avx512ifma,
+    add_n_bmi2_adx, sub_n_bmi2_adx, mul_1_bmi2_adx, addmul_1_bmi2_adx, submul_1_bmi2_adx,
+    lshift_bmi2_adx, rshift_bmi2_adx, mul_basecase_ifma, sqr_basecase_ifma,
+    bitwise_avx512<and_op>, bitwise_avx512<ior_op>, bitwise_avx512<xor_op>, com_n_avx512, equal_n_avx512, cmp_n_avx512,
+    IFMA_KARATSUBA_THRESHOLD, IFMA_KARATSUBA_THRESHOLD,
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "modulus_context.h"
+#include "limb_kernels.h"
+
+#include <stdexcept>
+#include <vector>
+
+modulus_context::modulus_context(big_integer const& modulus) : m(modulus), mu(1) {
+    if (m <= 0) {
+        throw std::runtime_error("Modulus must be positive");
+    }
+    mu <<= static_cast<int>(64 * m.size());
+    mu /= m;
+}
+
+big_integer const& modulus_context::modulus() const {
+    return m;
+}
+
+bool modulus_context::reduced(big_integer const& a) const {
+    return !a.sign && a < m;
+}
+
+big_integer modulus_context::reduce(big_integer const& a) const {
+    size_t const k = m.size();
+    size_t const n = a.size();
+    if (n > 2 * k) {
+        big_integer r = a % m;
+        return r.sign ? r += m : r;
+    }
+    uint32_t const* x = a.digits.begin();
+    uint32_t const* md = m.digits.begin();
+
+    std::vector<uint32_t> r(k + 1);
+    std::copy_n(x, std::min(n, k + 1), r.begin());
+    if (n >= k) {
+        // q = floor(floor(x / b^(k-1)) * mu / b^(k+1)) is at most 2 less than floor(x / m)
+        size_t const qn = n - k + 1;
+        std::vector<uint32_t> q(qn + mu.size());
+        mul(q.data(), x + k - 1, qn, mu.digits.begin(), mu.size());
+        uint32_t const* q3 = q.data() + k + 1;
+        size_t const q3n = q.size() - (k + 1);
+
+        // r = (x - q * m) mod b^(k+1)
+        std::vector<uint32_t> qm(q3n + k);
+        mul(qm.data(), q3, q3n, md, k);
+        sub_n(r.data(), r.data(), qm.data(), std::min(qm.size(), k + 1));
+    }
+    auto at_least_m = [&] {
+        if (r[k] != 0) {
+            return true;
+        }
+        size_t i = k;
+        while (i > 0 && r[i - 1] == md[i - 1]) {
+            i--;
+        }
+        return i == 0 || r[i - 1] > md[i - 1];
+    };
+    while (at_least_m()) {
+        r[k] -= sub_n(r.data(), r.data(), md, k);
+    }
+
+    big_integer result;
+    result.assign_magnitude(r.data(), k, false);
+    if (a.sign && result != 0) {
+        return m - result;
+    }
+    return result;
+}
+
+big_integer modulus_context::mulmod(big_integer const& a, big_integer const& b) const {
+    if (!reduced(a) || !reduced(b)) {
+        return mulmod(reduce(a), reduce(b));
+    }
+    return reduce(a * b);
+}
+
+big_integer modulus_context::addmod(big_integer const& a, big_integer const& b) const {
+    if (!reduced(a) || !reduced(b)) {
+        return addmod(reduce(a), reduce(b));
+    }
+    big_integer r = a + b;
+    return r >= m ? r -= m : r;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "big_integer.h"
+
+// Precomputed Barrett reciprocal mu = floor(2^(64k) / m) of a k-limb modulus m,
+// so that reducing a value below m^2 takes two multiplications instead of a
+// long division. Results are always in [0, m).
+struct modulus_context {
+    explicit modulus_context(big_integer const& modulus);
+
+    big_integer const& modulus() const;
+
+    big_integer reduce(big_integer const& a) const;
+    big_integer mulmod(big_integer const& a, big_integer const& b) const;
+    big_integer addmod(big_integer const& a, big_integer const& b) const;
+
+private:
+    big_integer m;
+    big_integer mu;
+
+    bool reduced(big_integer const& a) const;
+};
@@ -10,7 +10,7 @@ T const& as_const(T& obj) {
   return obj;
 }
 
-template<typename T>
+template<typename T, bool nothrow_move = false>
 struct element {
   element() {
     add_instance();
@@ -25,6 +25,11 @@ struct element {
     add_instance();
   }
 
+  element(element&& rhs) noexcept(nothrow_move) : val(rhs.val) {
+    rhs.assert_exists();
+    add_instance();
+  }
+
   element& operator=(element const& rhs) {
     assert_exists();
     rhs.assert_exists();
@@ -33,6 +38,13 @@ struct element {
     return *this;
   }
 
+  element& operator=(element&& rhs) noexcept(nothrow_move) {
+    assert_exists();
+    rhs.assert_exists();
+    val = rhs.val;
+    return *this;
+  }
+
   ~element() {
     delete_instance();
   }
@@ -53,6 +65,14 @@ struct element {
     throw_countdown = val;
   }
 
+  static size_t copies() {
+    return copy_count;
+  }
+
+  static void reset_copies() {
+    copy_count = 0;
+  }
+
   friend bool operator==(element const& a, element const& b) {
     return a.val == b.val;
   }
@@ -89,6 +109,7 @@ private:
   }
 
   void copy() {
+    ++copy_count;
     if (throw_countdown != 0) {
       --throw_countdown;
       if (throw_countdown == 0)
@@ -99,10 +120,14 @@ private:
 private:
   T val;
   static size_t throw_countdown;
+  static size_t copy_count;
 };
 
-template<typename T>
-size_t element<T>::throw_countdown = 0;
+template<typename T, bool nothrow_move>
+size_t element<T, nothrow_move>::throw_countdown = 0;
+
+template<typename T, bool nothrow_move>
+size_t element<T, nothrow_move>::copy_count = 0;
 
 TEST(correctness, default_ctor) {
   vector<element<int> > a;
@@ -322,6 +347,95 @@ TEST(correctness, insert_end) {
   element<size_t>::expect_no_instances();
 }
 
+TEST(correctness, push_back_rvalue) {
+  using el_t = element<size_t, true>;
+  size_t const N = 500;
+  {
+    vector<el_t> a;
+    el_t::reset_copies();
+    for (size_t i = 0; i != N; ++i) a.push_back(el_t(i));
+    EXPECT_EQ(0, el_t::copies());
+
+    for (size_t i = 0; i != N; ++i) EXPECT_EQ(i, a[i]);
+  }
+  el_t::expect_no_instances();
+}
+
+TEST(correctness, emplace_back) {
+  using el_t = element<size_t, true>;
+  size_t const N = 500;
+  {
+    vector<el_t> a;
+    el_t::reset_copies();
+    for (size_t i = 0; i != N; ++i) a.emplace_back(2 * i + 1);
+    EXPECT_EQ(0, el_t::copies());
+
+    for (size_t i = 0; i != N; ++i) EXPECT_EQ(2 * i + 1, a[i]);
+  }
+  el_t::expect_no_instances();
+}
+
+TEST(correctness, reallocation_moves) {
+  using el_t = element<size_t, true>;
+  size_t const N = 500;
+  {
+    vector<el_t> a;
+    el_t x(42);
+    el_t::reset_copies();
+    for (size_t i = 0; i != N; ++i) a.push_back(x);
+    EXPECT_EQ(N, el_t::copies());
+  }
+  el_t::expect_no_instances();
+}
+
+TEST(correctness, reallocation_copies_throwing_move) {
+  size_t const N = 500;
+  {
+    vector<element<size_t> > a;
+    element<size_t>::reset_copies();
+    for (size_t i = 0; i != N; ++i) a.emplace_back(i);
+    EXPECT_LT(0, element<size_t>::copies());
+
+    for (size_t i = 0; i != N; ++i) EXPECT_EQ(i, a[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, move_ctor) {
+  size_t const N = 500;
+  {
+    vector<element<size_t> > a;
+    for (size_t i = 0; i != N; ++i) a.push_back(i);
+    element<size_t>* old_data = a.data();
+
+    element<size_t>::reset_copies();
+    vector<element<size_t> > b = std::move(a);
+    EXPECT_EQ(0, element<size_t>::copies());
+    EXPECT_EQ(old_data, b.data());
+    EXPECT_TRUE(a.empty());
+    for (size_t i = 0; i != N; ++i) EXPECT_EQ(i, b[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, move_assignment) {
+  size_t const N = 500;
+  {
+    vector<element<size_t> > a;
+    for (size_t i = 0; i != N; ++i) a.push_back(2 * i + 1);
+
+    vector<element<size_t> > b;
+    b.push_back(42);
+
+    element<size_t>::reset_copies();
+    b = std::move(a);
+    EXPECT_EQ(0, element<size_t>::copies());
+    EXPECT_EQ(N, b.size());
+    for (size_t i = 0; i != N; ++i) EXPECT_EQ(2 * i + 1, b[i]);
+  }
+  element<size_t>::expect_no_instances();
+}
+
 TEST(performance, insert)
 {
     const size_t N = 10000;
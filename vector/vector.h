@@ -1,3 +1,10 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 template <typename T>
 struct vector
 {
@@ -7,6 +14,8 @@ struct vector
     vector();                               // O(1) nothrow
     vector(vector const&);                  // O(N) strong
     vector& operator=(vector const& other); // O(N) strong
+    vector(vector&&) noexcept;              // O(1) nothrow
+    vector& operator=(vector&& other) noexcept; // O(N) nothrow
 
     ~vector();                              // O(N) nothrow
 
@@ -23,6 +32,9 @@ struct vector
     T& back();                              // O(1) nothrow
     T const& back() const;                  // O(1) nothrow
     void push_back(T const&);               // O(1)* strong
+    void push_back(T&&);                    // O(1)* strong
+    template <typename... Args>
+    void emplace_back(Args&&... args);      // O(1)* strong
     void pop_back();                        // O(1) nothrow
 
     bool empty() const;                     // O(1) nothrow
@@ -52,11 +64,436 @@ struct vector
 
 private:
     size_t increase_capacity() const;
-    void push_back_realloc(T const&);
+    template <typename... Args>
+    void emplace_back_realloc(Args&&... args);
     void new_buffer(size_t new_capacity);
 
+    // elements of a trivially copyable T are copied with memcpy
+    typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value> trivial;
+
+    static T* allocate(size_t n);
+    static void deallocate(T* p);
+    static void copy_construct(T* dst, T const* src, size_t n);
+    static void copy_construct(T* dst, T const* src, size_t n, std::true_type);
+    static void copy_construct(T* dst, T const* src, size_t n, std::false_type);
+    static void relocate(T* dst, T* src, size_t n);
+    static void relocate(T* dst, T* src, size_t n, std::true_type);
+    static void relocate(T* dst, T* src, size_t n, std::false_type);
+    static void destroy(T* p, size_t n);
+
 private:
     T* data_;
     size_t size_;
     size_t capacity_;
-};
\ No newline at end of file
+};
+
+template <typename T>
+void swap(vector<T>& a, vector<T>& b)
+{
+    a.swap(b);
+}
+
+template <typename T>
+T* vector<T>::allocate(size_t n)
+{
+    return n == 0 ? nullptr : static_cast<T*>(operator new(n * sizeof(T)));
+}
+
+template <typename T>
+void vector<T>::deallocate(T* p)
+{
+    operator delete(p);
+}
+
+template <typename T>
+void vector<T>::copy_construct(T* dst, T const* src, size_t n)
+{
+    copy_construct(dst, src, n, trivial());
+}
+
+template <typename T>
+void vector<T>::copy_construct(T* dst, T const* src, size_t n, std::true_type)
+{
+    if (n != 0)
+        std::memcpy(static_cast<void*>(dst), static_cast<void const*>(src), n * sizeof(T));
+}
+
+template <typename T>
+void vector<T>::copy_construct(T* dst, T const* src, size_t n, std::false_type)
+{
+    size_t i = 0;
+    try
+    {
+        for (; i != n; ++i)
+            new (dst + i) T(src[i]);
+    }
+    catch (...)
+    {
+        destroy(dst, i);
+        throw;
+    }
+}
+
+template <typename T>
+void vector<T>::relocate(T* dst, T* src, size_t n)
+{
+    relocate(dst, src, n, trivial());
+}
+
+template <typename T>
+void vector<T>::relocate(T* dst, T* src, size_t n, std::true_type)
+{
+    copy_construct(dst, src, n, std::true_type());
+}
+
+// elements are moved unless their move constructor may throw and they can
+// be copied instead, which keeps the source intact for the strong guarantee
+template <typename T>
+void vector<T>::relocate(T* dst, T* src, size_t n, std::false_type)
+{
+    size_t i = 0;
+    try
+    {
+        for (; i != n; ++i)
+            new (dst + i) T(std::move_if_noexcept(src[i]));
+    }
+    catch (...)
+    {
+        destroy(dst, i);
+        throw;
+    }
+}
+
+template <typename T>
+void vector<T>::destroy(T* p, size_t n)
+{
+    if (!std::is_trivially_destructible<T>::value)
+        for (size_t i = n; i != 0; --i)
+            p[i - 1].~T();
+}
+
+template <typename T>
+vector<T>::vector()
+    : data_(nullptr)
+    , size_(0)
+    , capacity_(0)
+{}
+
+template <typename T>
+vector<T>::vector(vector const& other)
+    : data_(nullptr)
+    , size_(0)
+    , capacity_(0)
+{
+    if (other.size_ == 0)
+        return;
+    data_ = allocate(other.size_);
+    try
+    {
+        copy_construct(data_, other.data_, other.size_);
+    }
+    catch (...)
+    {
+        deallocate(data_);
+        throw;
+    }
+    size_ = capacity_ = other.size_;
+}
+
+template <typename T>
+vector<T>::vector(vector&& other) noexcept
+    : data_(other.data_)
+    , size_(other.size_)
+    , capacity_(other.capacity_)
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+}
+
+template <typename T>
+vector<T>& vector<T>::operator=(vector&& other) noexcept
+{
+    vector tmp(std::move(other));
+    swap(tmp);
+    return *this;
+}
+
+template <typename T>
+vector<T>& vector<T>::operator=(vector const& other)
+{
+    if (this != &other)
+    {
+        vector tmp(other);
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <typename T>
+vector<T>::~vector()
+{
+    destroy(data_, size_);
+    deallocate(data_);
+}
+
+template <typename T>
+T& vector<T>::operator[](size_t i)
+{
+    return data_[i];
+}
+
+template <typename T>
+T const& vector<T>::operator[](size_t i) const
+{
+    return data_[i];
+}
+
+template <typename T>
+T* vector<T>::data()
+{
+    return data_;
+}
+
+template <typename T>
+T const* vector<T>::data() const
+{
+    return data_;
+}
+
+template <typename T>
+size_t vector<T>::size() const
+{
+    return size_;
+}
+
+template <typename T>
+T& vector<T>::front()
+{
+    return data_[0];
+}
+
+template <typename T>
+T const& vector<T>::front() const
+{
+    return data_[0];
+}
+
+template <typename T>
+T& vector<T>::back()
+{
+    return data_[size_ - 1];
+}
+
+template <typename T>
+T const& vector<T>::back() const
+{
+    return data_[size_ - 1];
+}
+
+template <typename T>
+void vector<T>::push_back(T const& value)
+{
+    emplace_back(value);
+}
+
+template <typename T>
+void vector<T>::push_back(T&& value)
+{
+    emplace_back(std::move(value));
+}
+
+template <typename T>
+template <typename... Args>
+void vector<T>::emplace_back(Args&&... args)
+{
+    if (size_ == capacity_)
+    {
+        emplace_back_realloc(std::forward<Args>(args)...);
+        return;
+    }
+    new (data_ + size_) T(std::forward<Args>(args)...);
+    ++size_;
+}
+
+template <typename T>
+void vector<T>::pop_back()
+{
+    --size_;
+    data_[size_].~T();
+}
+
+template <typename T>
+bool vector<T>::empty() const
+{
+    return size_ == 0;
+}
+
+template <typename T>
+size_t vector<T>::capacity() const
+{
+    return capacity_;
+}
+
+template <typename T>
+void vector<T>::reserve(size_t new_capacity)
+{
+    if (new_capacity > capacity_)
+        new_buffer(new_capacity);
+}
+
+template <typename T>
+void vector<T>::shrink_to_fit()
+{
+    if (size_ != capacity_)
+        new_buffer(size_);
+}
+
+template <typename T>
+void vector<T>::clear()
+{
+    destroy(data_, size_);
+    size_ = 0;
+}
+
+template <typename T>
+void vector<T>::swap(vector& other)
+{
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+}
+
+template <typename T>
+typename vector<T>::iterator vector<T>::begin()
+{
+    return data_;
+}
+
+template <typename T>
+typename vector<T>::iterator vector<T>::end()
+{
+    return data_ + size_;
+}
+
+template <typename T>
+typename vector<T>::const_iterator vector<T>::begin() const
+{
+    return data_;
+}
+
+template <typename T>
+typename vector<T>::const_iterator vector<T>::end() const
+{
+    return data_ + size_;
+}
+
+template <typename T>
+typename vector<T>::iterator vector<T>::insert(iterator pos, T const& value)
+{
+    return insert(static_cast<const_iterator>(pos), value);
+}
+
+// the new element is appended and then swapped into place, so elements
+// that own resources (vector<vector<int>>) are moved in O(1) each
+template <typename T>
+typename vector<T>::iterator vector<T>::insert(const_iterator pos, T const& value)
+{
+    size_t index = pos - data_;
+    push_back(value);
+    using std::swap;
+    for (size_t i = size_ - 1; i != index; --i)
+        swap(data_[i], data_[i - 1]);
+    return data_ + index;
+}
+
+template <typename T>
+typename vector<T>::iterator vector<T>::erase(iterator pos)
+{
+    return erase(static_cast<const_iterator>(pos));
+}
+
+template <typename T>
+typename vector<T>::iterator vector<T>::erase(const_iterator pos)
+{
+    return erase(pos, pos + 1);
+}
+
+template <typename T>
+typename vector<T>::iterator vector<T>::erase(iterator first, iterator last)
+{
+    return erase(static_cast<const_iterator>(first), static_cast<const_iterator>(last));
+}
+
+template <typename T>
+typename vector<T>::iterator vector<T>::erase(const_iterator first, const_iterator last)
+{
+    size_t index = first - data_;
+    size_t count = last - first;
+    if (count != 0)
+    {
+        std::move(data_ + index + count, data_ + size_, data_ + index);
+        destroy(data_ + size_ - count, count);
+        size_ -= count;
+    }
+    return data_ + index;
+}
+
+template <typename T>
+size_t vector<T>::increase_capacity() const
+{
+    return capacity_ == 0 ? 1 : capacity_ * 2;
+}
+
+// args may refer to an element of this vector, so the new element is
+// constructed in the new buffer before the old elements are relocated
+template <typename T>
+template <typename... Args>
+void vector<T>::emplace_back_realloc(Args&&... args)
+{
+    size_t new_capacity = increase_capacity();
+    T* new_data = allocate(new_capacity);
+    try
+    {
+        new (new_data + size_) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        deallocate(new_data);
+        throw;
+    }
+    try
+    {
+        relocate(new_data, data_, size_);
+    }
+    catch (...)
+    {
+        new_data[size_].~T();
+        deallocate(new_data);
+        throw;
+    }
+    destroy(data_, size_);
+    deallocate(data_);
+    data_ = new_data;
+    ++size_;
+    capacity_ = new_capacity;
+}
+
+template <typename T>
+void vector<T>::new_buffer(size_t new_capacity)
+{
+    T* new_data = allocate(new_capacity);
+    try
+    {
+        relocate(new_data, data_, size_);
+    }
+    catch (...)
+    {
+        deallocate(new_data);
+        throw;
+    }
+    destroy(data_, size_);
+    deallocate(data_);
+    data_ = new_data;
+    capacity_ = new_capacity;
+}